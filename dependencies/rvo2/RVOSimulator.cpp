@@ -63,7 +63,9 @@
 #include "KdTree.h"
 #include "Obstacle.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <new>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -75,6 +77,9 @@
 
 namespace RVO
 {
+  // Agents per storage chunk
+  static const size_t AGENT_CHUNK_SIZE = 128;
+
   RVOSimulator::RVOSimulator() : agents_(), defaultAgent_(0), globalTime_(0.0f), kdTree_(0), obstacles_(), timeStep_(1.0f)
   {
     kdTree_ = new KdTree(this);
@@ -100,8 +105,11 @@ namespace RVO
       delete defaultAgent_;
     }
 
-    for (size_t i = 0; i < agents_.size(); ++i) {
-      delete agents_[i];
+    for (size_t i = 0; i < agentChunks_.size(); ++i) {
+      for (size_t j = 0; j < AGENT_CHUNK_SIZE; ++j) {
+        agentChunks_[i][j].~Agent();
+      }
+      ::operator delete(agentChunks_[i]);
     }
 
     for (size_t i = 0; i < obstacles_.size(); ++i) {
@@ -141,13 +149,63 @@ namespace RVO
     return agents_[agentNo]->orcaLines_[lineNo];
   }
 
+  Agent* RVOSimulator::agentSlot(size_t agentNo) const
+  {
+    return &agentChunks_[agentNo / AGENT_CHUNK_SIZE][agentNo % AGENT_CHUNK_SIZE];
+  }
+
+  void RVOSimulator::growAgentSlots(size_t numSlots)
+  {
+    while (agentChunks_.size() * AGENT_CHUNK_SIZE < numSlots) {
+      Agent* chunk = static_cast<Agent*>(::operator new(sizeof(Agent) * AGENT_CHUNK_SIZE));
+      for (size_t i = 0; i < AGENT_CHUNK_SIZE; ++i) {
+        new (&chunk[i]) Agent(this);
+      }
+      agentChunks_.push_back(chunk);
+    }
+    while (agents_.size() < numSlots) {
+      freeAgentNos_.insert(agents_.size());
+      agents_.push_back(NULL);
+    }
+  }
+
+  size_t RVOSimulator::allocateAgentNo()
+  {
+    if (freeAgentNos_.empty()) {
+      growAgentSlots(agents_.size() + 1);
+    }
+    // Lowest first, so agent numbers only depend on the add & remove order
+    size_t agentNo = *freeAgentNos_.begin();
+    freeAgentNos_.erase(freeAgentNos_.begin());
+
+    Agent* agent = agentSlot(agentNo);
+    agent->id_ = agentNo;
+    agents_[agentNo] = agent;
+    return agentNo;
+  }
+
+  void RVOSimulator::releaseAgentSlot(size_t agentNo)
+  {
+    // Keep the vectors' capacity for the next agent in this slot
+    Agent* agent = agentSlot(agentNo);
+    agent->agentNeighbors_.clear();
+    agent->obstacleNeighbors_.clear();
+    agent->orcaLines_.clear();
+    agent->newVelocity_ = Vector2();
+    agent->prefVelocity_ = Vector2();
+
+    agents_[agentNo] = NULL;
+    freeAgentNos_.insert(agentNo);
+  }
+
   size_t RVOSimulator::addAgent(const Vector2& position)
   {
     if (defaultAgent_ == 0) {
       return RVO_ERROR;
     }
 
-    Agent* agent = new Agent(this);
+    size_t agentNo = allocateAgentNo();
+    Agent* agent = agents_[agentNo];
 
     agent->position_ = position;
     agent->maxNeighbors_ = defaultAgent_->maxNeighbors_;
@@ -158,16 +216,13 @@ namespace RVO
     agent->timeHorizonObst_ = defaultAgent_->timeHorizonObst_;
     agent->velocity_ = defaultAgent_->velocity_;
 
-    agent->id_ = agents_.size();
-
-    agents_.push_back(agent);
-
-    return agents_.size() - 1;
+    return agentNo;
   }
 
   size_t RVOSimulator::addAgent(const Vector2& position, float neighborDist, size_t maxNeighbors, float timeHorizon, float timeHorizonObst, float radius, float maxSpeed, const Vector2& velocity)
   {
-    Agent* agent = new Agent(this);
+    size_t agentNo = allocateAgentNo();
+    Agent* agent = agents_[agentNo];
 
     agent->position_ = position;
     agent->maxNeighbors_ = maxNeighbors;
@@ -178,27 +233,14 @@ namespace RVO
     agent->timeHorizonObst_ = timeHorizonObst;
     agent->velocity_ = velocity;
 
-    for (int i = 0; i < agents_.size(); i++)
-    {
-      if (agents_[i] == NULL)
-      {
-        agent->id_ = i;
-        agents_[i] = agent;
-        return i;
-      }
-    }
-
-    agent->id_ = agents_.size();
-
-    agents_.push_back(agent);
-
-    return agents_.size() - 1;
+    return agentNo;
   }
 
   void RVOSimulator::removeAgent(size_t agentNo)
   {
-    delete agents_[agentNo];
-    agents_[agentNo] = NULL;
+    if (agentNo < agents_.size() && agents_[agentNo] != NULL) {
+      releaseAgentSlot(agentNo);
+    }
   }
 
   size_t RVOSimulator::addObstacle(const std::vector<Vector2>& vertices)
@@ -236,6 +278,49 @@ namespace RVO
     return obstacleNo;
   }
 
+  void RVOSimulator::clearObstacles()
+  {
+    for (size_t i = 0; i < obstacles_.size(); ++i) {
+      delete obstacles_[i];
+    }
+    obstacles_.clear();
+    kdTree_->buildObstacleTree();
+
+    for (size_t i = 0; i < agents_.size(); ++i) {
+      if (agents_[i] != NULL) {
+        agents_[i]->obstacleNeighbors_.clear();
+      }
+    }
+  }
+
+  void RVOSimulator::computeVelocitiesRange(void* data, size_t begin, size_t end)
+  {
+    const std::vector<Agent*>& agents = *static_cast<std::vector<Agent*>*>(data);
+    for (size_t i = begin; i < end; ++i) {
+      agents[i]->computeNeighbors();
+      agents[i]->computeNewVelocity();
+    }
+  }
+
+  void RVOSimulator::updateRange(void* data, size_t begin, size_t end)
+  {
+    const std::vector<Agent*>& agents = *static_cast<std::vector<Agent*>*>(data);
+    for (size_t i = begin; i < end; ++i) {
+      agents[i]->update();
+    }
+  }
+
+  void RVOSimulator::doStep(ParallelFor parallelFor, void* pool)
+  {
+    kdTree_->buildAgentTree();
+
+    // All new velocities must be computed before any agent moves
+    parallelFor(pool, kdTree_->agents_.size(), computeVelocitiesRange, &kdTree_->agents_);
+    parallelFor(pool, kdTree_->agents_.size(), updateRange, &kdTree_->agents_);
+
+    globalTime_ += timeStep_;
+  }
+
   void RVOSimulator::doStep()
   {
     kdTree_->buildAgentTree();
@@ -311,6 +396,11 @@ namespace RVO
     return agents_.size();
   }
 
+  size_t RVOSimulator::getNumLiveAgents() const
+  {
+    return agents_.size() - freeAgentNos_.size();
+  }
+
   size_t RVOSimulator::getNumObstacleVertices() const
   {
     return obstacles_.size();
@@ -412,10 +502,67 @@ namespace RVO
   }
   void RVOSimulator::changeAgentNo(size_t agentNo, size_t newAgentNo)
   {
-    if (newAgentNo > agents_.size()) {
-       agents_.resize(newAgentNo+1, NULL);
+    if (agentNo == newAgentNo) {
+      return;
+    }
+    growAgentSlots(std::max(agentNo, newAgentNo) + 1);
+    if (agents_[agentNo] == NULL) {
+      std::swap(agentNo, newAgentNo);
+    }
+    if (agents_[agentNo] == NULL) {
+      return; // Both removed, nothing to swap
+    }
+
+    Agent* from = agentSlot(agentNo);
+    Agent* to = agentSlot(newAgentNo);
+    if (agents_[newAgentNo] != NULL) {
+      Agent swapped = *to;
+      *to = *from;
+      *from = swapped;
+      from->id_ = agentNo;
+    } else {
+      *to = *from;
+      freeAgentNos_.erase(newAgentNo);
+      agents_[newAgentNo] = to;
+      releaseAgentSlot(agentNo);
     }
-    std::swap(agents_[agentNo], agents_[newAgentNo]);
+    to->id_ = newAgentNo;
   }
-}
 
+  size_t RVOSimulator::compactAgents(std::vector<size_t>& remap)
+  {
+    remap.assign(agents_.size(), RVO_ERROR);
+
+    size_t numAgents = 0;
+    for (size_t i = 0; i < agents_.size(); ++i) {
+      if (agents_[i] == NULL) {
+        continue;
+      }
+      if (i != numAgents) {
+        Agent* agent = agentSlot(numAgents);
+        *agent = *agents_[i];
+        agent->id_ = numAgents;
+        agents_[numAgents] = agent;
+        releaseAgentSlot(i);
+      }
+      remap[i] = numAgents++;
+    }
+    agents_.resize(numAgents);
+    freeAgentNos_.clear();
+
+    size_t numChunks = (numAgents + AGENT_CHUNK_SIZE - 1) / AGENT_CHUNK_SIZE;
+    for (size_t i = numChunks; i < agentChunks_.size(); ++i) {
+      for (size_t j = 0; j < AGENT_CHUNK_SIZE; ++j) {
+        agentChunks_[i][j].~Agent();
+      }
+      ::operator delete(agentChunks_[i]);
+    }
+    agentChunks_.resize(std::min(numChunks, agentChunks_.size()));
+
+    // Neighbors may point at moved agents, they are recomputed next step
+    for (size_t i = 0; i < numAgents; ++i) {
+      agents_[i]->agentNeighbors_.clear();
+    }
+    return numAgents;
+  }
+}
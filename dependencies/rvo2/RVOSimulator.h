@@ -66,6 +66,7 @@
 #define RVO_SIMULATOR_H
 
 #include <limits>
+#include <set>
 #include <vector>
 
 #include "Vector2.h"
@@ -99,6 +100,18 @@ namespace RVO
   class KdTree;
   class Obstacle;
 
+  /*!
+   *  @brief      A function over the half-open range [begin, end) of agents,
+   *              called by a ParallelFor.
+   */
+  typedef void (*ParallelRange)(void* data, size_t begin, size_t end);
+
+  /*!
+   *  @brief      Calls range(data, begin, end) over disjoint ranges covering
+   *              [0, n), possibly concurrently, and returns once all are done.
+   */
+  typedef void (*ParallelFor)(void* pool, size_t n, ParallelRange range, void* data);
+
   /*!
    *  @brief      Defines the simulation.
    *
@@ -221,6 +234,16 @@ namespace RVO
     // Hacked in for Lanarts
     void changeAgentNo(size_t agentNo, size_t newAgentNo);
 
+    /*!
+     *  @brief      Moves the agents to the lowest agent numbers, keeping
+     *              their order, and releases the storage of removed agents.
+     *              Simulation results are unaffected.
+     *  @param      remap           Set to the new number of each old agent
+     *                              number, or RVO_ERROR for removed agents.
+     *  @returns    The count of agents after compaction.
+     */
+    size_t compactAgents(std::vector<size_t>& remap);
+
     /*!
      *  @brief      Removes an agent from the simulation.
      *  @param      agentNo         The number of the agent to be
@@ -240,6 +263,12 @@ namespace RVO
      */
     size_t addObstacle(const std::vector<Vector2>& vertices);
 
+    /*!
+     *  @brief      Removes all obstacles from the simulation, so that a new
+     *              set can be added and processed.
+     */
+    void clearObstacles();
+
     /*!
      *  @brief      Lets the simulator perform a simulation step and updates the
      *              two-dimensional position and two-dimensional velocity of
@@ -247,6 +276,16 @@ namespace RVO
      */
     void doStep();
 
+    /*!
+     *  @brief      Performs a simulation step like doStep, computing the new
+     *              velocities and updating the agents through parallelFor.
+     *              The result does not depend on how the agents are split,
+     *              as every agent only writes its own state in each pass.
+     *  @param      parallelFor     Runs the agent ranges, eg on a thread pool.
+     *  @param      pool            Passed to parallelFor.
+     */
+    void doStep(ParallelFor parallelFor, void* pool);
+
     /*!
      *  @brief      Returns the specified agent neighbor of the specified
      *              agent.
@@ -409,6 +448,12 @@ namespace RVO
      */
     size_t getNumAgents() const;
 
+    /*!
+     *  @brief      Returns the count of agents that have not been removed.
+     *  @returns    The count of agents that have not been removed.
+     */
+    size_t getNumLiveAgents() const;
+
     /*!
      *  @brief      Returns the count of obstacle vertices in the simulation.
      *  @returns    The count of obstacle vertices in the simulation.
@@ -613,7 +658,20 @@ namespace RVO
     void setTimeStep(float timeStep);
 
   private:
+    static void computeVelocitiesRange(void* data, size_t begin, size_t end);
+    static void updateRange(void* data, size_t begin, size_t end);
+
+    // Agents live in fixed-size chunks, so agent pointers stay valid as the
+    // simulation grows. agents_[i] is either NULL or the agent in slot i.
+    Agent* agentSlot(size_t agentNo) const;
+    void growAgentSlots(size_t numSlots);
+    size_t allocateAgentNo();
+    void releaseAgentSlot(size_t agentNo);
+
     std::vector<Agent*> agents_;
+    std::vector<Agent*> agentChunks_;
+    // Removed agent numbers, reused lowest first
+    std::set<size_t> freeAgentNos_;
     Agent* defaultAgent_;
     float globalTime_;
     KdTree* kdTree_;
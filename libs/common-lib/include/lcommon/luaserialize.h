@@ -65,6 +65,7 @@ private:
 	bool test_has_metamethod(int idx);
 	void encode_metatable(int idx);
 	void encode_table(int idx);
+	void encode_key(int idx);
 	void encode_function(int idx);
 
 	void store_object(int idx);
@@ -26,13 +26,26 @@ enum lstype_t {
 	LS_REF_NAME,
 	// Decodes by calling __load on the object's decoded metatable, with decoded arguments:
 	LS_REF_METAMETHOD,
-	LS_NOVALUE
+	LS_NOVALUE,
+	// A string key seen for the first time; later uses are written as LS_REF_ID:
+	LS_KEY_STRING
 };
 
+/* Integrity check written after every table. By default this is a checksum of
+ * its keys. Defining LUASERIALIZE_DEBUG_KEYS writes every key instead, and
+ * defining LUASERIALIZE_NO_CHECKSUM writes nothing. */
+#if defined(LUASERIALIZE_DEBUG_KEYS)
+#define LUASERIALIZE_CHECK_KEYS
+#elif !defined(LUASERIALIZE_NO_CHECKSUM)
+#define LUASERIALIZE_CHECK_CHECKSUM
+#endif
+
 
 #define abs_index(L, i) ((i) > 0 || (i) <= LUA_REGISTRYINDEX ? (i) : \
                                         lua_gettop(L) + (i) + 1)
 
+#ifdef LUASERIALIZE_CHECK_KEYS
+
 static std::vector<std::string> get_keys(const LuaValue& value) {
     if (value.empty()) {
         return {};
@@ -62,7 +75,6 @@ static std::vector<std::string> get_keys(const LuaValue& value) {
 }
 
 static void encode_keys(SerializeBuffer& serializer, const LuaValue& value) {
-    // TODO if ndebug
     serializer.write_container(get_keys(value));
 }
 
@@ -79,46 +91,87 @@ static void decode_keys(SerializeBuffer& serializer, const LuaValue& value) {
     }
 }
 
+#endif
+
+// FNV-1a
+static unsigned int hash_bytes(const char* data, size_t len) {
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+// Order independent, so that tables can be iterated differently when decoded
+static unsigned int key_checksum(lua_State* L, int idx, unsigned int checksum) {
+	unsigned int hash;
+	if (lua_type(L, idx) == LUA_TSTRING) {
+		size_t len;
+		const char* str = lua_tolstring(L, idx, &len);
+		hash = hash_bytes(str, len);
+	} else if (lua_type(L, idx) == LUA_TNUMBER) {
+		lua_Number num = lua_tonumber(L, idx);
+		hash = hash_bytes((const char*)&num, sizeof(num));
+	} else {
+		hash = lua_type(L, idx);
+	}
+	return checksum + hash;
+}
+
 /***************************************************************************************
  *                           Lua value encoding                                        *
  ***************************************************************************************/
 
-// On success, writes [LS_TABLE, (key encoding, value encoding)*, LS_TABLE_END_SENTINEL]
+// On success, writes [LS_TABLE, (key encoding, value encoding)*, LS_TABLE_END_SENTINEL, <key check>]
 void LuaSerializeContext::encode_table(int idx) {
+    idx = abs_index(L, idx);
+    unsigned int checksum = 0;
     lua_pushvalue(L, idx);
 	lua_pushnil(L);
 	while (lua_next(L, -2) != 0) {
-        const char* name = NULL;
-        const char* type_name = NULL;
-		if (lua_type(L, -2) == LUA_TSTRING) {
-			name = lua_tostring(L, -2);
-            type_name = lua_typename(L, lua_type(L, -1));
-			//printf("ENCODING '%s' as '%s'\n", lua_tostring(L, -2), lua_typename(L, lua_type(L, -1)));
-		}
-        LuaValue k{L, -2};
-        LuaValue v{L, -1};
-		encode(-2);
+		int key_idx = lua_gettop(L) - 1;
+		checksum = key_checksum(L, key_idx, checksum);
+		encode_key(key_idx);
         try {
-        encode(-1);
+            encode(key_idx + 1);
         } catch (...) {
-            //
+            // Key and value are still in place on the stack
             printf("Error occurred -- dumping Lua object at %d\n", idx);
             lua_getglobal(L, "pretty_table_safe");
-            k.push();
+            lua_pushvalue(L, key_idx);
             lua_call(L, 1, 0);
             printf("Value\n");
             lua_getglobal(L, "pretty_table_safe");
-            v.push();
+            lua_pushvalue(L, key_idx + 1);
             lua_call(L, 1, 0);
-            //
             throw;
         };
 		lua_pop(L, 1);
 	}
 	buffer->write_byte(LS_TABLE_END_SENTINEL);
 	lua_pop(L, 1);
+#if defined(LUASERIALIZE_CHECK_KEYS)
     {LuaValue VALUE{L, idx};
         encode_keys(*buffer, VALUE);}
+#elif defined(LUASERIALIZE_CHECK_CHECKSUM)
+    buffer->write_int(checksum);
+#endif
+}
+
+// String keys are written once per stream, and referred to by id afterwards
+void LuaSerializeContext::encode_key(int idx) {
+	if (lua_type(L, idx) != LUA_TSTRING) {
+		encode(idx);
+		return;
+	}
+	if (!test_has_ref(idx)) {
+		size_t len;
+		const char* str = lua_tolstring(L, idx, &len);
+		buffer->write_byte(LS_KEY_STRING);
+		buffer->write_int(len);
+		buffer->write_raw(str, len);
+		store_ref_id(idx);
+	}
 }
 
 // On success, writes [LS_REF_ID, <ref id>] or [LS_REF_NAME, <ref name>]
@@ -345,6 +398,11 @@ void LuaSerializeContext::_decode(int type) {
 		decode_ref_metamethod();
 		LCOMMON_ASSERT(old_stack == lua_gettop(L));
 		return;
+	case LS_KEY_STRING:
+		decode_string();
+		store_object(-1);
+		LCOMMON_ASSERT(old_stack == lua_gettop(L));
+		return;
 	case LS_NIL:
 		lua_pushnil(L);
 		LCOMMON_ASSERT(old_stack == lua_gettop(L));
@@ -360,19 +418,24 @@ void LuaSerializeContext::_decode(int type) {
 
 void LuaSerializeContext::decode_table(int idx) {
     idx = abs_index(L, idx);
+    unsigned int checksum = 0;
 	lua_pushvalue(L, idx);
 	int type;
 	while ((type = buffer->read_byte()) != LS_TABLE_END_SENTINEL) {
 		_decode(type);
-		if (lua_type(L, -1) == LUA_TSTRING) {
-			//printf("DECODING '%s'\n", lua_tostring(L, -1));
-		}
+		checksum = key_checksum(L, -1, checksum);
 		decode();
 		lua_rawset(L, -3);
 	}
 	lua_pop(L, 1);
+#if defined(LUASERIALIZE_CHECK_KEYS)
     {LuaValue VALUE{L, idx};
         decode_keys(*buffer, VALUE);}
+#elif defined(LUASERIALIZE_CHECK_CHECKSUM)
+    if ((unsigned int)buffer->read_int() != checksum) {
+        throw std::runtime_error("Corrupted load!");
+    }
+#endif
 }
 
 // Simple string holder to pass to our lua_Reader.
@@ -558,7 +621,9 @@ void LuaSerializeConfig::encode(SerializeBuffer& serializer,
 	context.encode(value);
 	sync_indices(context);
 	lua_pop(L, 4);
+#ifdef LUASERIALIZE_CHECK_KEYS
     encode_keys(serializer,  value);
+#endif
 }
 
 
@@ -567,6 +632,7 @@ void LuaSerializeConfig::decode(SerializeBuffer& serializer, LuaValue& value) {
 	context.decode(value);
 	sync_indices(context);
 	lua_pop(L, 4);
+#ifdef LUASERIALIZE_CHECK_KEYS
     const char* str = NULL;
 	if (!value.empty() && !value.isnil()) { // DEBUG LOOKUPS
 		this->obj_to_index.push();
@@ -579,6 +645,7 @@ void LuaSerializeConfig::decode(SerializeBuffer& serializer, LuaValue& value) {
 		lua_pop(L, 1);
 	}
     decode_keys(serializer, value);
+#endif
 }
 
 static void lua_table_clear(lua_State* L, int table_idx) {
@@ -30,6 +30,8 @@ struct GLImage {
 
 	void subimage_from_bytes(const BBox& region, char* data);
 	void image_from_bytes(const Size& size, char* data);
+	// GL_LINEAR or GL_NEAREST, nothing to filter when headless
+	void set_filter(int filter);
 
 	void draw(const ldraw::DrawOptions& options, const PosF& pos);
 	void draw(const PosF& pos) {
@@ -37,6 +39,10 @@ struct GLImage {
 	}
 	static void start_batch_draw();
 	void batch_draw(const BBoxF& region, const PosF& pos);
+	// Draw an already positioned quad, with texture coordinates in [0,1]
+	void batch_draw_quad(const BBoxF& texbox, const BBox& quad,
+			const Colour& colour);
+	static bool is_batch_drawing();
         static void end_batch_draw();
 
 	int width, height;
@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <list>
 #include <stdexcept>
+#include <unordered_map>
 #include <vector>
 
 #include <ft2build.h>
@@ -44,11 +46,56 @@ struct char_data {
 	~char_data();
 };
 
+/*A single glyph quad, relative to the (origin-adjusted) draw position */
+struct glyph_quad {
+	int x, y, w, h;
+	unsigned char glyph;
+};
+
+/*The result of word wrapping & placing every glyph of a string */
+struct text_layout {
+	std::vector<glyph_quad> quads;
+	SizeF measured_size; // Size used for origin adjustment
+	SizeF draw_size; // Size reported back to callers
+};
+
+/*LRU cache of text layouts, keyed by (string, max width).
+ * Each font owns its own cache, so the font is implicitly part of the key.
+ * HUD, chat & floating text redraw the same strings every frame, so this
+ * avoids redoing the word wrapping & glyph placement. Glyph metrics do not
+ * change once a font is loaded, and initialize() creates a new font_data, so
+ * entries never go stale. */
+class text_layout_cache {
+public:
+	text_layout_cache(size_t capacity = 512) :
+			_capacity(capacity) {
+	}
+	const text_layout& get(const font_data& font, const char* text,
+			int maxwidth);
+	size_t size() const {
+		return _entries.size();
+	}
+private:
+	struct entry {
+		size_t hash;
+		int maxwidth;
+		std::string text;
+		text_layout layout;
+	};
+	typedef std::list<entry> EntryList;
+
+	size_t _capacity;
+	EntryList _entries; // Most recently used in front
+	std::unordered_map<size_t, EntryList::iterator> _index;
+	std::vector<int> _line_splits; // Reused scratch space for layouts
+};
+
 /*Holds all of the information related to any freetype font that we want to create.*/
 struct font_data {
 	GLImage font_img;
 	char_data data[128];
 	float h; //Height of the font
+	text_layout_cache layout_cache;
 	font_data() {
 		h = 0;
 	}
@@ -151,9 +198,6 @@ void init_font(font_data* fd, const char* fname, unsigned int h) {
  *  Text display routines & helper functions                      *
  ******************************************************************/
 
-static void gl_draw_glyph(const font_data& font, char glyph, const PosF& pos,
-		const SizeF& scale) {}
-
 /*Splits up strings, respecting space boundaries & returns maximum width */
 static int process_string(const font_data& font, const char* text,
 		int max_width, std::vector<int>& line_splits) {
@@ -186,25 +230,15 @@ static int process_string(const font_data& font, const char* text,
 	return largest_width;
 }
 
-//
-/* General gl_print function for others to delegate to */
-static SizeF gl_print_impl(const DrawOptions& options, const font_data& font,
-		PosF p, int maxwidth, bool actually_print, const char* text) {
-	perf_timer_begin(FUNCNAME);
+/*Word wraps 'text' and places every visible glyph, relative to (0,0) */
+static void layout_text(const font_data& font, const char* text, int maxwidth,
+		std::vector<int>& line_splits, text_layout& layout) {
+	line_splits.clear();
+	layout.quads.clear();
 
-	LDRAW_ASSERT(options.draw_region == BBoxF());
-	LDRAW_ASSERT(options.draw_angle == 0.0f);
-	LDRAW_ASSERT(options.draw_frame == 0.0f);
-	LDRAW_ASSERT(options.draw_scale == SizeF(1.0f, 1.0f));
-
-	std::vector<int> line_splits;
 	int measured_width = process_string(font, text, maxwidth, line_splits);
-	int height = font.h * line_splits.size();
-
-	p = adjusted_for_origin(p, SizeF(measured_width, height),
-			options.draw_origin);
-
-	const Colour& c = options.draw_colour;
+	layout.measured_size = SizeF(measured_width,
+			font.h * line_splits.size());
 
 	Size size(0, 0);
 	for (int linenum = 0, i = 0; linenum < line_splits.size(); linenum++) {
@@ -220,17 +254,103 @@ static SizeF gl_print_impl(const DrawOptions& options, const font_data& font,
 			}
 			const char_data& cdata = font.data[chr];
 			len += cdata.advance;
-			if (actually_print) {
-				Pos drawpos(p.x + len - (cdata.advance - cdata.left),
-						p.y + size.h - cdata.move_up);
-				gl_draw_glyph(font, chr, drawpos, options.draw_scale);
+			if (cdata.w != 0 && cdata.h != 0) {
+				glyph_quad quad;
+				quad.x = len - (cdata.advance - cdata.left);
+				quad.y = size.h - cdata.move_up;
+				quad.w = cdata.w, quad.h = cdata.h;
+				quad.glyph = chr;
+				layout.quads.push_back(quad);
 			}
 		}
 		size.w = std::max(len, size.w);
 		size.h += 1;
 	}
+	layout.draw_size = size;
+}
+
+static size_t layout_hash(const char* text, int maxwidth) {
+	// FNV-1a, seeded with the max width
+	size_t hash = 2166136261u ^ (size_t)maxwidth;
+	for (const char* c = text; *c; c++) {
+		hash = (hash ^ (unsigned char)*c) * 16777619u;
+	}
+	return hash;
+}
+
+const text_layout& text_layout_cache::get(const font_data& font,
+		const char* text, int maxwidth) {
+	size_t hash = layout_hash(text, maxwidth);
+	auto it = _index.find(hash);
+	if (it != _index.end()) {
+		entry& e = *it->second;
+		// Move to the front of the LRU list
+		_entries.splice(_entries.begin(), _entries, it->second);
+		if (e.maxwidth == maxwidth && e.text == text) {
+			return e.layout;
+		}
+		// Hash collision, overwrite the entry in place
+	} else if (_entries.size() >= _capacity) {
+		// Recycle the least recently used entry, keeping its buffers
+		_index.erase(_entries.back().hash);
+		_entries.splice(_entries.begin(), _entries, --_entries.end());
+		_index[hash] = _entries.begin();
+	} else {
+		_entries.push_front(entry());
+		_index[hash] = _entries.begin();
+	}
+
+	entry& e = _entries.front();
+	e.hash = hash;
+	e.maxwidth = maxwidth;
+	e.text = text;
+	layout_text(font, text, maxwidth, _line_splits, e.layout);
+	return e.layout;
+}
+
+/* Submits a laid out string through the shared sprite batcher.
+ * If the caller has not started a batch, the string forms its own batch. */
+static void gl_draw_layout(const font_data& font, const text_layout& layout,
+		const PosF& p, const Colour& colour) {
+	bool own_batch = !GLImage::is_batch_drawing();
+	if (own_batch) {
+		GLImage::start_batch_draw();
+	}
+
+	GLImage& img = const_cast<GLImage&>(font.font_img);
+	for (int i = 0; i < layout.quads.size(); i++) {
+		const glyph_quad& quad = layout.quads[i];
+		const char_data& cdata = font.data[quad.glyph];
+		Pos drawpos(p.x + quad.x, p.y + quad.y);
+		img.batch_draw_quad(BBoxF(cdata.tx1, cdata.ty1, cdata.tx2, cdata.ty2),
+				BBox(drawpos, Size(quad.w, quad.h)), colour);
+	}
+
+	if (own_batch) {
+		GLImage::end_batch_draw();
+	}
+}
+
+//
+/* General gl_print function for others to delegate to */
+static SizeF gl_print_impl(const DrawOptions& options, font_data& font,
+		PosF p, int maxwidth, bool actually_print, const char* text) {
+	perf_timer_begin(FUNCNAME);
+
+	LDRAW_ASSERT(options.draw_region == BBoxF());
+	LDRAW_ASSERT(options.draw_angle == 0.0f);
+	LDRAW_ASSERT(options.draw_frame == 0.0f);
+	LDRAW_ASSERT(options.draw_scale == SizeF(1.0f, 1.0f));
+
+	const text_layout& layout = font.layout_cache.get(font, text, maxwidth);
+
+	if (actually_print) {
+		p = adjusted_for_origin(p, layout.measured_size, options.draw_origin);
+		gl_draw_layout(font, layout, p, options.draw_colour);
+	}
+
 	perf_timer_end(FUNCNAME);
-	return size;
+	return layout.draw_size;
 }
 
 /******************************************************************
@@ -90,6 +90,9 @@ void Image::from_bytes(const Size& size, char* data) {
 	_draw_region = BBoxF(0, 0, _image->width, _image->height);
 }
 
+void Image::set_smooth(bool smooth) {
+}
+
 std::vector<Image> image_split(const Image & image, const SizeF & size) {
 	std::vector<Image> results;
 
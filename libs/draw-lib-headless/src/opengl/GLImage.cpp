@@ -59,6 +59,9 @@ void GLImage::image_from_bytes(const Size& size, char* data) {
 	gl_image_from_bytes(*this, size, data);
 }
 
+void GLImage::set_filter(int filter) {
+}
+
 void GLImage::draw(const ldraw::DrawOptions& options, const PosF& pos) {
 }
 
@@ -69,5 +72,13 @@ void GLImage::start_batch_draw() {
 void GLImage::batch_draw(const BBoxF& bbox, const PosF& pos) {
 }
 
+void GLImage::batch_draw_quad(const BBoxF& texbox, const BBox& quad,
+        const Colour& colour) {
+}
+
+bool GLImage::is_batch_drawing() {
+    return false;
+}
+
 void GLImage::end_batch_draw() {
 }
@@ -18,16 +18,19 @@
 struct GLImage {
 	GLImage() {
 		texture = 0;
+		filter = GL_LINEAR;
 	}
 	GLImage(SDL_RWops* rw_ops) {
 
 	}
 	GLImage(const std::string& filename) {
 		texture = 0;
+		filter = GL_LINEAR;
 		initialize(filename);
 	}
 	GLImage(const Size& size, int type = GL_RGBA) {
 		texture = 0;
+		filter = GL_LINEAR;
 		initialize(size, type);
 	}
 	~GLImage();
@@ -40,6 +43,8 @@ struct GLImage {
 	void subimage_from_bytes(const BBox& region, char* data,
 			int type = GL_RGBA);
 	void image_from_bytes(const Size& size, char* data, int type = GL_RGBA);
+	// GL_LINEAR or GL_NEAREST, kept across uploads
+	void set_filter(GLint filter);
 
 	void draw(const ldraw::DrawOptions& options, const PosF& pos);
 	void draw(const PosF& pos) {
@@ -47,11 +52,16 @@ struct GLImage {
 	}
 	static void start_batch_draw();
 	void batch_draw(const BBoxF& region, const PosF& pos);
+	// Draw an already positioned quad, with texture coordinates in [0,1]
+	void batch_draw_quad(const BBoxF& texbox, const BBox& quad,
+			const Colour& colour);
+	static bool is_batch_drawing();
         static void end_batch_draw();
 
 	int width, height;
 	float texw, texh;
 	GLuint texture;
+	GLint filter;
 };
 
 #endif /* GLIMAGE_H_ */
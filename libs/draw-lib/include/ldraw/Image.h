@@ -78,6 +78,8 @@ public:
 			bool rotates = false);
 	void from_bytes(const BBox& region, char* data);
 	void from_bytes(const Size& size, char* data);
+	/* Whether scaling blends pixels (the default), or keeps them sharp */
+	void set_smooth(bool smooth);
 
 	virtual void push_metatable(lua_State* L) const;
 private:
@@ -94,6 +94,11 @@ void Image::from_bytes(const Size& size, char* data) {
 	_draw_region = BBoxF(0, 0, _image->width, _image->height);
 }
 
+void Image::set_smooth(bool smooth) {
+	LDRAW_ASSERT(!_image.empty());
+	_image->set_filter(smooth ? GL_LINEAR : GL_NEAREST);
+}
+
 std::vector<Image> image_split(const Image & image, const SizeF & size) {
 	std::vector<Image> results;
 
@@ -122,8 +122,8 @@ static void gl_subimage_from_bytes(GLImage& img, const BBox& region, char* data,
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, img.filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, img.filter);
 	glTexSubImage2D(GL_TEXTURE_2D, 0, region.x1, region.y1, region.width(),
 			region.height(), type, GL_UNSIGNED_BYTE, data);
 	glDisable(GL_TEXTURE_2D);
@@ -151,8 +151,8 @@ static void gl_image_from_bytes(GLImage& img, const Size& size, char* data,
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, img.filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, img.filter);
 	if (!was_init)
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ptw, pth, 0, type,
 				GL_UNSIGNED_BYTE, NULL);
@@ -200,6 +200,15 @@ void GLImage::image_from_bytes(const Size& size, char* data, int type) {
 	gl_image_from_bytes(*this, size, data, type);
 }
 
+void GLImage::set_filter(GLint filter) {
+	this->filter = filter;
+	if (texture) {
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	}
+}
+
 void GLImage::draw(const ldraw::DrawOptions& options, const PosF& pos) {
 	BBoxF draw_region(0, 0, width, height);
 
@@ -230,25 +239,34 @@ void GLImage::draw(const ldraw::DrawOptions& options, const PosF& pos) {
 
 
 struct BatchDrawer {
+    bool in_batch = false;
     bool mid_draw = false;
     GLuint last_texture = (GLuint)-1;
+    Colour last_colour;
 
-    void start_draw(GLuint texture) {
+    void start_draw(GLuint texture, const Colour& colour = Colour()) {
         if (last_texture != texture) {
             end_draw();
             last_texture = texture;
             glBindTexture(GL_TEXTURE_2D, texture);
             glBegin(GL_QUADS);
-            glColor4ub(255, 255, 255, 255);
+            last_colour = colour;
+            glColor4ub(colour.r, colour.g, colour.b, colour.a);
             mid_draw = true;
+        } else if (last_colour != colour) {
+            // Colour changes are legal mid glBegin/glEnd
+            last_colour = colour;
+            glColor4ub(colour.r, colour.g, colour.b, colour.a);
         }
     }
     void start_batch() {
+        in_batch = true;
         glEnable(GL_TEXTURE_2D);
     }
     void end_batch() {
         end_draw();
         glDisable(GL_TEXTURE_2D);
+        in_batch = false;
     }
 private:
     void end_draw() {
@@ -285,6 +303,28 @@ void GLImage::batch_draw(const BBoxF& bbox, const PosF& pos) {
     glVertex(imgbox.pos[3]);
 }
 
+void GLImage::batch_draw_quad(const BBoxF& texbox, const BBox& quad,
+        const Colour& colour) {
+    batch_drawer.start_draw(texture, colour);
+
+    //Draw our four points, clockwise.
+    glTexCoord2f(texbox.x1, texbox.y1);
+    glVertex2i(quad.x1, quad.y1);
+
+    glTexCoord2f(texbox.x2, texbox.y1);
+    glVertex2i(quad.x2, quad.y1);
+
+    glTexCoord2f(texbox.x2, texbox.y2);
+    glVertex2i(quad.x2, quad.y2);
+
+    glTexCoord2f(texbox.x1, texbox.y2);
+    glVertex2i(quad.x1, quad.y2);
+}
+
+bool GLImage::is_batch_drawing() {
+    return batch_drawer.in_batch;
+}
+
 void GLImage::end_batch_draw() {
     batch_drawer.end_batch();
 }
@@ -10,6 +10,7 @@
 
 #include <cstring>
 #include <map>
+#include <vector>
 
 #include <lcommon/mtwist.h>
 #include <lcommon/Grid.h>
@@ -39,6 +40,16 @@ namespace ldungeon_gen {
 		}
 	};
 
+	/* A template's selectors & operators laid out for one orientation,
+	 * indexed by the squares of 'size' in map row order */
+	struct OrientedTemplate {
+		Size size;
+		std::vector<Selector> selectors;
+		std::vector<Operator> opers;
+		/* Index into the above for each template square, in template row order */
+		std::vector<int> indices;
+	};
+
 	/* Attempts to place a template in the given location */
 	class AreaTemplate {
 	public:
@@ -55,8 +66,17 @@ namespace ldungeon_gen {
 			return _grid->size();
 		}
 	private:
+		void compile();
+		void apply_with_events(MapPtr map, const Pos& xy, const OrientedTemplate& oriented);
+
 		smartptr< Grid<char> > _grid;
 		std::map<char, Glyph> _legend;
+
+		/* Compiled from the grid & legend on first use, one per orientation */
+		std::vector<OrientedTemplate> _oriented;
+		/* Template squares with a placement event, in template row order */
+		std::vector<int> _event_squares;
+		std::vector<LuaValue> _event_values;
 	};
 
 	typedef smartptr<AreaTemplate> AreaTemplatePtr;
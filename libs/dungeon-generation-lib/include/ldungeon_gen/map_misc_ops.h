@@ -12,6 +12,32 @@
 #include <vector>
 
 namespace ldungeon_gen {
+    /* A 4-connected region of squares that match a selector */
+    struct MapComponent {
+        int size;
+        BBox bbox;
+        Pos first; // First square in row-major order
+    };
+
+    struct MapComponents {
+        BBox area;
+        // Component of each square of 'area' by row, or -1 if it did not match
+        std::vector<int> labels;
+        // Ordered by their first square
+        std::vector<MapComponent> components;
+
+        // -1 if 'xy' did not match or is outside of 'area'
+        int label(Pos xy) const;
+        // -1 if there are no components
+        int largest() const;
+    };
+
+    /* Labels the components of the squares matching 'selector' in one go,
+     * with a two-pass union-find over the rows of 'area'. */
+    void area_components(Map& map, BBox area, Selector selector, MapComponents& components);
+    /* Applies 'fill' to every labelled square outside of component 'keep' */
+    void area_components_fill(Map& map, const MapComponents& components, int keep, Operator fill);
+
     bool area_fully_connected(Map& map, BBox area, Selector unfilled, Operator mark, Selector marked);
     void area_fill_unconnected(Map& map, BBox area, Pos seed, Selector unfilled, Operator mark, Selector marked, Operator fill);
 
@@ -0,0 +1,34 @@
+/*
+ * map_span.h:
+ *  Kernels that match & operate on runs of adjacent squares in a map row.
+ *  Selectors and operators are reduced to masks once per run, leaving
+ *  branch-free per-square work that the compiler can vectorize.
+ */
+
+#ifndef LDUNGEON_MAP_SPAN_H_
+#define LDUNGEON_MAP_SPAN_H_
+
+#include <vector>
+
+#include "Map.h"
+
+namespace ldungeon_gen {
+	/* Applies 'oper' to the 'n' squares starting at 'row' */
+	void span_apply(Square* row, int n, const Operator& oper);
+	void span_apply(Square* row, int n, const ConditionalOperator& oper);
+
+	/* Whether all 'n' squares starting at 'row' match */
+	bool span_all_match(const Square* row, int n, const Selector& selector);
+
+	/* Offset of the first square matching 'selector', or -1 */
+	int span_find_match(const Square* row, int n, const Selector& selector);
+	/* Offset of the first square matching 'selector' but not 'excluded', or -1 */
+	int span_find_match(const Square* row, int n, const Selector& selector,
+			const Selector& excluded);
+
+	/* Appends the offsets of the squares matching 'selector' */
+	void span_collect_matches(const Square* row, int n, const Selector& selector,
+			std::vector<int>& offsets);
+}
+
+#endif /* LDUNGEON_MAP_SPAN_H_ */
@@ -0,0 +1,62 @@
+/*
+ * region_spread.h:
+ *  Separates map regions with RVO steering, a native version of the
+ *  GenerateUtils.RVORegionPlacer loop used to lay out MapCompiler regions.
+ */
+
+#ifndef LDUNGEON_REGION_SPREAD_H_
+#define LDUNGEON_REGION_SPREAD_H_
+
+#include <vector>
+
+#include <lcommon/mtwist.h>
+
+namespace ldungeon_gen {
+
+	/* How each region's preferred velocity is picked every iteration, matching
+	 * the region delta functions of GenerateUtils */
+	enum RegionSpreadMode {
+		// spread_region_delta_func: random jitter of up to 2 on each axis
+		SPREAD_RANDOM,
+		// center_region_delta_func: full speed towards a centre point
+		SPREAD_TOWARDS_CENTER
+	};
+
+	struct SpreadRegion {
+		// Bounding box, x & y are moved by region_spread
+		double x, y, w, h;
+		float max_speed;
+		SpreadRegion(double x, double y, double w, double h, float max_speed = 1) :
+				x(x), y(y), w(w), h(h), max_speed(max_speed) {
+		}
+	};
+
+	struct RegionSpreadSettings {
+		RegionSpreadMode mode;
+		int max_iterations;
+		// Stop once no region moves further than this in an iteration. With 0,
+		// only stops at an exact fixed point, which gives the same layout as
+		// running every iteration.
+		double converge_epsilon;
+		double center_x, center_y;
+		RegionSpreadSettings(RegionSpreadMode mode, int max_iterations,
+				double converge_epsilon = 0, double center_x = 0, double center_y = 0) :
+				mode(mode), max_iterations(max_iterations), converge_epsilon(
+						converge_epsilon), center_x(center_x), center_y(center_y) {
+		}
+	};
+
+	/* Moves the regions apart, drawing from 'rng' in the same order as the Lua
+	 * placer. Returns the number of iterations run. */
+	int region_spread(MTwist& rng, std::vector<SpreadRegion>& regions,
+			const RegionSpreadSettings& settings);
+
+	struct RegionSpreadStats {
+		int calls, iterations;
+		long long microseconds;
+	};
+	/* Totals over all region_spread calls */
+	RegionSpreadStats region_spread_stats();
+}
+
+#endif /* LDUNGEON_REGION_SPREAD_H_ */
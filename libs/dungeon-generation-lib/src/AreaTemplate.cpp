@@ -33,6 +33,7 @@ namespace ldungeon_gen {
 
 	void AreaTemplate::define_glyph(char key, Glyph glyph) {
 		_legend[key] = glyph;
+		_oriented.clear(); /* Compile again with the new legend */
 	}
 
 	inline static Pos reorient(Pos xy, Size size, Orientation orientation) {
@@ -56,67 +57,118 @@ namespace ldungeon_gen {
 		}
 	}
 
-	void AreaTemplate::apply(MapPtr map, group_t parent_group_id,
-			const Pos& xy, Orientation orientation, bool create_subgroup) {
+	void AreaTemplate::compile() {
 		int w = _grid->width(), h = _grid->height();
+		BBox grid_rect(Pos(), _grid->size());
+
+		_oriented.assign(ORIENT_TURN_270 + 1, OrientedTemplate());
+		for (int orient = ORIENT_DEFAULT; orient <= ORIENT_TURN_270; orient++) {
+			OrientedTemplate& oriented = _oriented[orient];
+			bool turned = (orient == ORIENT_TURN_90 || orient == ORIENT_TURN_270);
+			oriented.size = turned ? Size(h,w) : Size(w,h);
+			oriented.selectors.resize(w * h);
+			oriented.opers.resize(w * h);
+			FOR_EACH_BBOX(grid_rect, x, y) {
+				Pos sqr = reorient(Pos(x,y), Size(w,h), (Orientation)orient);
+				int index = sqr.y * oriented.size.w + sqr.x;
+				const Glyph& glyph = _legend[(*_grid)[Pos(x,y)]];
+				oriented.selectors[index] = glyph.oper.selector;
+				oriented.opers[index] = glyph.oper.oper;
+				oriented.indices.push_back(index);
+			}
+		}
+
+		_event_squares.clear();
+		_event_values.clear();
+		FOR_EACH_BBOX(grid_rect, x, y) {
+			const Glyph& glyph = _legend[(*_grid)[Pos(x,y)]];
+			if (!glyph.value.empty() && !glyph.value.isnil()) {
+				_event_squares.push_back(y * w + x);
+				_event_values.push_back(glyph.value);
+			}
+		}
+	}
 
-		/* Push arguments only once, the moment we find our lua_State */
-		lua_State* L = NULL;
+	void AreaTemplate::apply(MapPtr map, group_t parent_group_id,
+			const Pos& xy, Orientation orientation, bool create_subgroup) {
+		LDUNGEON_ASSERT(orientation >= ORIENT_DEFAULT && orientation <= ORIENT_TURN_270);
+		if (_oriented.empty()) {
+			compile();
+		}
+		const OrientedTemplate& oriented = _oriented[orientation];
 
 		if (create_subgroup) {
-			Size adjustedsize = (orientation == ORIENT_TURN_90 || orientation == ORIENT_TURN_270) ? Size(h,w) : Size(w,h);
-			BBox rect(xy, adjustedsize);
-			map->make_group(rect, parent_group_id);
+			map->make_group(BBox(xy, oriented.size), parent_group_id);
 		}
-                /* Area of map to apply to: */
-		BBox grid_rect(Pos(), _grid->size());
-		FOR_EACH_BBOX(grid_rect, x, y) {
-			Pos sqr = xy + reorient(Pos(x,y), Size(w,h), orientation);
-			char chr = (*_grid)[Pos(x,y)];
-			Glyph glyph = _legend[chr];
 
-			(*map)[sqr].apply(glyph.oper.oper);
+		if (!_event_squares.empty()) {
+			apply_with_events(map, xy, oriented);
+			return;
+		}
 
-			/* Apply lua function */
-			if (!glyph.value.empty() && !glyph.value.isnil()) {
-				LDUNGEON_ASSERT(L == NULL || glyph.value.luastate() == L);
-				if (L == NULL) {
-					L = glyph.value.luastate();
-					luawrap::push(L, map);
-				}
-				LuaStackValue mapval(L, -1);
-				glyph.value.push();
+		/* Nothing can observe the order, stamp a row at a time */
+		BBox rect(xy, oriented.size);
+		LDUNGEON_ASSERT(rect.resized_within(BBox(Pos(), map->size())) == rect);
+		const Operator* oper = oriented.opers.data();
+		for (int y = 0; y < oriented.size.h; y++) {
+			Square* row = &(*map)[Pos(xy.x, xy.y + y)];
+			for (int x = 0; x < oriented.size.w; x++) {
+				row[x].apply(*oper++);
+			}
+		}
+	}
+
+	/* Events can look at the map, so go in template order and run each
+	 * square's event right after applying its operator */
+	void AreaTemplate::apply_with_events(MapPtr map, const Pos& xy,
+			const OrientedTemplate& oriented) {
+		/* Push the map only once */
+		lua_State* L = _event_values[0].luastate();
+		luawrap::push(L, map);
+		LuaStackValue mapval(L, -1);
+
+		size_t next_event = 0;
+		for (int i = 0; i < (int)oriented.indices.size(); i++) {
+			int index = oriented.indices[i];
+			Pos sqr = xy + Pos(index % oriented.size.w, index / oriented.size.w);
+			(*map)[sqr].apply(oriented.opers[index]);
+
+			if (next_event < _event_squares.size() && _event_squares[next_event] == i) {
+				const LuaValue& value = _event_values[next_event++];
+				LDUNGEON_ASSERT(value.luastate() == L);
+				value.push();
 				mapval.push();
 				luawrap::push(L, sqr);
 				lua_call(L, 2, 0);
 			}
 		}
 
-		if (L) {
-			/* Pop cached map and position objects */
-			lua_pop(L, 2);
-		}
+		/* Pop cached map */
+		lua_pop(L, 1);
 	}
 
 	bool AreaTemplate::matches(MapPtr map, group_t parent_group_id,
 			const Pos& xy, Orientation orientation) {
-		int w = _grid->width(), h = _grid->height();
-                /* Area of map to apply to: */
-		BBox grid_rect(Pos(), _grid->size());
-		FOR_EACH_BBOX(grid_rect, x, y) {
-			Pos sqr = xy + reorient(Pos(x,y), Size(w,h), orientation);
-                        if (sqr.x < 0 || sqr.x >= map->width() || sqr.y < 0 || sqr.y >= map->height()) {
-                            return false;
-                        }
-			char chr = (*_grid)[Pos(x,y)];
-			Glyph glyph = _legend[chr];
-
-			if (!(*map)[sqr].matches(glyph.oper.selector)) {
-                            return false;
-                        }
+		LDUNGEON_ASSERT(orientation >= ORIENT_DEFAULT && orientation <= ORIENT_TURN_270);
+		if (_oriented.empty()) {
+			compile();
 		}
-                return true;
-	}
-
+		const OrientedTemplate& oriented = _oriented[orientation];
 
+		/* Area of map to apply to: */
+		BBox rect(xy, oriented.size);
+		if (rect.resized_within(BBox(Pos(), map->size())) != rect) {
+			return false;
+		}
+		const Selector* selector = oriented.selectors.data();
+		for (int y = 0; y < oriented.size.h; y++) {
+			const Square* row = &(*map)[Pos(xy.x, xy.y + y)];
+			for (int x = 0; x < oriented.size.w; x++) {
+				if (!row[x].matches(*selector++)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
 }
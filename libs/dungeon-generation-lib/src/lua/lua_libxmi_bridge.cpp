@@ -19,6 +19,7 @@ extern "C" {
 #include <lcommon/smartptr.h>
 
 #include "map_fill.h"
+#include "map_span.h"
 
 // Convenience
 typedef std::vector<ldungeon_gen::ConditionalOperator> OperatorTable;
@@ -73,17 +74,14 @@ static inline bool apply_operation_to_lines(ldungeon_gen::Map& map, /*bounds*/ B
 			int xstart_clip = std::max(xstart, B.x1);
 			int xend_clip = std::min(xend, B.x2 - 1);
 
+			int width = xend_clip - xstart_clip + 1;
+			if (width <= 0) {
+				continue;
+			}
 			if (use_operator) {
-				for (int x = xstart_clip; x <= xend_clip; x++) {
-					map[Pos(x, y)].apply(oper);
-				}
-			} else {
-				// Selector
-				for (int x = xstart_clip; x <= xend_clip; x++) {
-					if (!map[Pos(x, y)].matches(selector)) {
-						return false;
-					}
-				}
+				ldungeon_gen::span_apply(&map[Pos(xstart_clip, y)], width, oper);
+			} else if (!ldungeon_gen::span_all_match(&map[Pos(xstart_clip, y)], width, selector)) {
+				return false;
 			}
 		}
 	}
@@ -100,6 +98,8 @@ static inline void collect_matches_to_lines(ldungeon_gen::Map& map, /*bounds*/ B
 		return;
 	}
 
+	std::vector<int> offsets;
+
 	for (int i = 0; i < n; i++) {
 		int y = ppt[i].y + offset.x;
 		if (y >= B.y2) {
@@ -112,11 +112,14 @@ static inline void collect_matches_to_lines(ldungeon_gen::Map& map, /*bounds*/ B
 			int xstart_clip = std::max(xstart, B.x1);
 			int xend_clip = std::min(xend, B.x2 - 1);
 
-			// Selector
-			for (int x = xstart_clip; x <= xend_clip; x++) {
-				if (map[Pos(x, y)].matches(selector)) {
-					matches.push_back(Pos(x,y));
-				}
+			int width = xend_clip - xstart_clip + 1;
+			if (width <= 0) {
+				continue;
+			}
+			offsets.clear();
+			ldungeon_gen::span_collect_matches(&map[Pos(xstart_clip, y)], width, selector, offsets);
+			for (int dx : offsets) {
+				matches.push_back(Pos(xstart_clip + dx, y));
 			}
 		}
 	}
@@ -614,6 +614,46 @@ namespace ldungeon_gen {
         area_fill_unconnected(*map, area, seed, unfilled, mark, marked, fill);
     }
 
+    /* map_components {map, selector, area = whole map, fill_operator = nil, keep_seed = nil}
+     * Returns a list of {size, bbox, first} components, and the index of the largest.
+     * With a fill_operator, fills every component except the one holding keep_seed,
+     * or the largest when keep_seed is not given or not in a component. */
+    static int lmap_components(lua_State* L) {
+        using namespace luawrap;
+        LuaStackValue args(L, 1);
+        MapPtr map = args["map"].as<MapPtr>();
+        Selector selector = lua_selector_get(args["selector"]);
+        BBox area = defaulted(args["area"], BBox(Pos(), map->size()));
+
+        MapComponents components;
+        area_components(*map, area, selector, components);
+        int largest = components.largest();
+        if (!args["fill_operator"].isnil()) {
+            int keep = args["keep_seed"].isnil() ? -1 : components.label(args["keep_seed"].as<Pos>());
+            Operator fill = lua_operator_get(args["fill_operator"]);
+            area_components_fill(*map, components, keep == -1 ? largest : keep, fill);
+        }
+
+        lua_createtable(L, components.components.size(), 0);
+        for (int i = 0; i < (int)components.components.size(); i++) {
+            MapComponent& component = components.components[i];
+            lua_createtable(L, 0, 3);
+            lua_pushinteger(L, component.size);
+            lua_setfield(L, -2, "size");
+            luawrap::push(L, component.bbox);
+            lua_setfield(L, -2, "bbox");
+            luawrap::push(L, component.first);
+            lua_setfield(L, -2, "first");
+            lua_rawseti(L, -2, i + 1);
+        }
+        if (largest == -1) {
+            lua_pushnil(L);
+        } else {
+            lua_pushinteger(L, largest + 1);
+        }
+        return 2;
+    }
+
     static void lerode_diagonal_pairs(LuaStackValue args) {
         using namespace luawrap;
         lua_State* L = args.luastate();
@@ -773,6 +813,7 @@ namespace ldungeon_gen {
         submodule["erode_diagonal_pairs"].bind_function(lerode_diagonal_pairs);
         submodule["area_fully_connected"].bind_function(larea_fully_connected);
         submodule["area_fill_unconnected"].bind_function(larea_fill_unconnected);
+        submodule["map_components"].bind_function(lmap_components);
 
 		LUAWRAP_SET_TYPE(LuaStackValue);
 		LUAWRAP_GETTER(submodule, random_place,
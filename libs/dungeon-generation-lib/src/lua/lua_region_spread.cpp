@@ -0,0 +1,103 @@
+/*
+ * lua_region_spread.cpp:
+ *  Bindings for the native region spreader.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <luawrap/luawrap.h>
+
+#include "region_spread.h"
+
+#include "lua_ldungeon_impl.h"
+
+namespace ldungeon_gen {
+
+	static void polygon_bounds(LuaField polygon, double& x1, double& y1, double& x2, double& y2) {
+		int n_points = polygon.objlen();
+		for (int i = 1; i <= n_points; i++) {
+			LuaField point = polygon[i];
+			double x = point[1].to_num(), y = point[2].to_num();
+			x1 = std::min(x1, x), y1 = std::min(y1, y);
+			x2 = std::max(x2, x), y2 = std::max(y2, y);
+		}
+	}
+
+	// Same box as MapRegion.map_region_bbox, over polygons & tunnel polygons
+	static SpreadRegion map_region_get(LuaField region) {
+		double x1 = HUGE_VAL, y1 = HUGE_VAL, x2 = -HUGE_VAL, y2 = -HUGE_VAL;
+		LuaField polygons = region["polygons"], tunnels = region["tunnels"];
+		int n_polygons = polygons.objlen();
+		for (int i = 1; i <= n_polygons; i++) {
+			polygon_bounds(polygons[i], x1, y1, x2, y2);
+		}
+		if (!tunnels.isnil()) {
+			int n_tunnels = tunnels.objlen();
+			for (int i = 1; i <= n_tunnels; i++) {
+				polygon_bounds(tunnels[i]["polygon"], x1, y1, x2, y2);
+			}
+		}
+		return SpreadRegion(x1, y1, x2 - x1, y2 - y1);
+	}
+
+	/* region_spread {rng, regions, mode = 'spread' or 'center', iterations = 1000,
+	 *   converge_epsilon = 0, center = {0, 0}}
+	 * Takes MapRegion-like tables and returns a list of {dx, dy} translations,
+	 * one per region, followed by the number of iterations run. */
+	static int lua_region_spread(lua_State* L) {
+		using namespace luawrap;
+		LuaStackValue args(L, 1);
+
+		std::string mode_name = defaulted(args["mode"], std::string("spread"));
+		RegionSpreadMode mode = SPREAD_RANDOM;
+		if (mode_name == "center") {
+			mode = SPREAD_TOWARDS_CENTER;
+		} else if (mode_name != "spread") {
+			return luaL_error(L, "Unknown region spread mode '%s'", mode_name.c_str());
+		}
+		RegionSpreadSettings settings(mode, defaulted(args["iterations"], 1000),
+				defaulted(args["converge_epsilon"], 0.0));
+		if (!args["center"].isnil()) {
+			settings.center_x = args["center"][1].to_num();
+			settings.center_y = args["center"][2].to_num();
+		}
+
+		LuaField lregions = args["regions"];
+		std::vector<SpreadRegion> regions;
+		int n_regions = lregions.objlen();
+		for (int i = 1; i <= n_regions; i++) {
+			regions.push_back(map_region_get(lregions[i]));
+		}
+		std::vector<SpreadRegion> original = regions;
+		int iterations = region_spread(*args["rng"].as<MTwist*>(), regions, settings);
+
+		lua_createtable(L, regions.size(), 0);
+		for (size_t i = 0; i < regions.size(); i++) {
+			lua_createtable(L, 2, 0);
+			lua_pushnumber(L, regions[i].x - original[i].x);
+			lua_rawseti(L, -2, 1);
+			lua_pushnumber(L, regions[i].y - original[i].y);
+			lua_rawseti(L, -2, 2);
+			lua_rawseti(L, -2, i + 1);
+		}
+		lua_pushinteger(L, iterations);
+		return 2;
+	}
+
+	// Returns calls, iterations & milliseconds spent over all region_spread calls
+	static int lua_region_spread_stats(lua_State* L) {
+		RegionSpreadStats stats = region_spread_stats();
+		lua_pushinteger(L, stats.calls);
+		lua_pushinteger(L, stats.iterations);
+		lua_pushnumber(L, stats.microseconds / 1000.0);
+		return 3;
+	}
+
+	void lua_register_region_spread(const LuaValue& module) {
+		module["region_spread"].bind_function(lua_region_spread);
+		module["region_spread_stats"].bind_function(lua_region_spread_stats);
+	}
+}
@@ -3,10 +3,12 @@
  *  Various algorithms for querying a map.
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 
 #include "map_check.h"
+#include "map_span.h"
 #include "bsp.hpp"
 
 namespace ldungeon_gen {
@@ -20,25 +22,25 @@ namespace ldungeon_gen {
 		const BBox map_bounds(Pos(0, 0), map.size());
 		BBox perm_bbox = bbox.grow(perimeter).resized_within(map_bounds);
 
-		int rowstart = perm_bbox.y1 * map.width();
+		/* Columns of the inside, the rest of the row is perimeter */
+		int inner_x1 = perm_bbox.x1, inner_x2 = perm_bbox.x2;
+		if (perimeter != 0) {
+			inner_x1 = std::min(std::max(bbox.x1, perm_bbox.x1), perm_bbox.x2);
+			inner_x2 = std::max(inner_x1, std::min(bbox.x2, perm_bbox.x2));
+		}
 		for (int y = perm_bbox.y1; y < perm_bbox.y2; y++) {
-
-			int idx = rowstart + perm_bbox.x1;
-			for (int x = perm_bbox.x1; x < perm_bbox.x2; x++) {
-				if (perimeter == 0 || bbox.contains(x, y)) {
-					/* Inside the box */
-					if (!map.raw_get(idx).matches(fill_selector)) {
-						return false;
-					}
-				} else {
-					/* On the perimeter*/
-					if (!map.raw_get(idx).matches(perimeter_selector)) {
-						return false;
-					}
+			const Square* row = &map.raw_get(y * map.width());
+			if (perimeter != 0 && (y < bbox.y1 || y >= bbox.y2)) {
+				if (!span_all_match(row + perm_bbox.x1, perm_bbox.width(), perimeter_selector)) {
+					return false;
 				}
-				idx++;
+				continue;
+			}
+			if (!span_all_match(row + perm_bbox.x1, inner_x1 - perm_bbox.x1, perimeter_selector)
+					|| !span_all_match(row + inner_x1, inner_x2 - inner_x1, fill_selector)
+					|| !span_all_match(row + inner_x2, perm_bbox.x2 - inner_x2, perimeter_selector)) {
+				return false;
 			}
-			rowstart += map.width();
 		}
 
 		return true;
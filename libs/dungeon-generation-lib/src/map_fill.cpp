@@ -3,11 +3,13 @@
  *  Various algorithms for filling a map.
  */
 
+#include <algorithm>
 #include <cstdlib>
 
 #include "ldungeon_assert.h"
 
 #include "map_fill.h"
+#include "map_span.h"
 #include "bsp.hpp"
 
 void event_log(const char* fmt, ...);
@@ -50,21 +52,21 @@ namespace ldungeon_gen {
 			map->groups.at(grp).group_area = inner_rect;
 		}
 
-		int rowstart = rect.y1 * map->width();
+		/* Columns of the inside, the rest of the row is perimeter */
+		int inner_x1 = rect.x1, inner_x2 = rect.x2;
+		if (perimeter != 0) {
+			inner_x1 = std::min(std::max(inner_rect.x1, rect.x1), rect.x2);
+			inner_x2 = std::max(inner_x1, std::min(inner_rect.x2, rect.x2));
+		}
 		for (int y = rect.y1; y < rect.y2; y++) {
-
-			int idx = rowstart + rect.x1;
-			for (int x = rect.x1; x < rect.x2; x++) {
-				if (perimeter == 0 || inner_rect.contains(x, y)) {
-					/* Inside the box */
-					map->raw_get(idx).apply(fill_oper);
-				} else {
-					/* On the perimeter*/
-					map->raw_get(idx).apply(perimeter_oper);
-				}
-				idx++;
+			Square* row = &map->raw_get(y * map->width());
+			if (perimeter != 0 && (y < inner_rect.y1 || y >= inner_rect.y2)) {
+				span_apply(row + rect.x1, rect.width(), perimeter_oper);
+				continue;
 			}
-			rowstart += map->width();
+			span_apply(row + rect.x1, inner_x1 - rect.x1, perimeter_oper);
+			span_apply(row + inner_x1, inner_x2 - inner_x1, fill_oper);
+			span_apply(row + inner_x2, rect.x2 - inner_x2, perimeter_oper);
 		}
 		return true;
 	}
@@ -4,7 +4,9 @@
  */
 
 #include "map_misc_ops.h"
+#include "map_span.h"
 
+#include <algorithm>
 #include <vector>
 
 //
@@ -71,15 +73,26 @@ void area_connected_search_mark(Map& map, BBox area, Pos seed, Selector unfilled
     }
 }
 
+// The seed the original FOR_EACH_BBOX scans picked: their 'break' only left the
+// row loop, so this is the first match in the last row that has one.
+static bool area_find_seed(Map& map, BBox area, Selector unfilled, Pos& seed) {
+    if (area.width() <= 0) {
+        return false;
+    }
+    for (int y = area.y2 - 1; y >= area.y1; y--) {
+        int x = span_find_match(&map[Pos(area.x1, y)], area.width(), unfilled);
+        if (x != -1) {
+            seed = Pos(area.x1 + x, y);
+            return true;
+        }
+    }
+    return false;
+}
+
 namespace ldungeon_gen {
     void area_fill_unconnected(Map& map, BBox area, Pos seed, Selector unfilled, Operator mark, Selector marked, Operator fill) {
         if (!map[seed].matches(unfilled)) {
-            FOR_EACH_BBOX(area, x, y) {
-                if (map[Pos(x,y)].matches(unfilled)) {
-                    seed = Pos(x, y);
-                    break;
-                }
-            }
+            area_find_seed(map, area, unfilled, seed);
             if (seed.x == -1 && seed.y == -1) {
                 return; // Fully filled area is fully connected, technically.
             }
@@ -98,20 +111,14 @@ namespace ldungeon_gen {
     bool area_fully_connected(Map& map, BBox area, Selector unfilled, Operator mark, Selector marked) {
         // Find first unfilled element:
         Pos seed {-1, -1};
-        FOR_EACH_BBOX(area, x, y) {
-            if (map[Pos(x,y)].matches(unfilled)) {
-                seed = Pos(x, y);
-                break;
-            }
-        }
-        if (seed.x == -1 && seed.y == -1) {
+        if (!area_find_seed(map, area, unfilled, seed)) {
             return true; // Fully filled area is fully connected, technically.
         }
 
         area_connected_search_mark(map, area, seed, unfilled, mark, marked);
 
-        FOR_EACH_BBOX(area, x, y) {
-            if (map[Pos(x,y)].matches(unfilled) && !map[Pos(x,y)].matches(marked)) {
+        for (int y = area.y1; y < area.y2; y++) {
+            if (span_find_match(&map[Pos(area.x1, y)], area.width(), unfilled, marked) != -1) {
                 return false;
             }
         }
@@ -145,4 +152,107 @@ namespace ldungeon_gen {
             }
         }
     }
+
+    int MapComponents::label(Pos xy) const {
+        if (!area.contains(xy)) {
+            return -1;
+        }
+        return labels[(xy.y - area.y1) * area.width() + (xy.x - area.x1)];
+    }
+
+    int MapComponents::largest() const {
+        int best = -1;
+        for (int i = 0; i < (int)components.size(); i++) {
+            if (best == -1 || components[i].size > components[best].size) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    static int union_find_root(std::vector<int>& parent, int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Keeps the earlier label as the root, so roots are first in row-major order
+    static void union_find_join(std::vector<int>& parent, int a, int b) {
+        a = union_find_root(parent, a), b = union_find_root(parent, b);
+        if (a < b) {
+            parent[b] = a;
+        } else {
+            parent[a] = b;
+        }
+    }
+
+    void area_components(Map& map, BBox area, Selector selector, MapComponents& components) {
+        area = area.resized_within(BBox(Pos(0, 0), map.size()));
+        int w = std::max(area.width(), 0), h = std::max(area.height(), 0);
+        if (w == 0) {
+            h = 0;
+        }
+        components.area = area;
+        components.labels.assign(w * h, -1);
+        components.components.clear();
+        std::vector<int>& labels = components.labels;
+
+        // First pass: a provisional label per run of matches, joined with the runs above
+        std::vector<int> parent, offsets;
+        for (int row = 0; row < h; row++) {
+            offsets.clear();
+            span_collect_matches(&map[Pos(area.x1, area.y1 + row)], w, selector, offsets);
+            int* labels_row = &labels[row * w];
+            const int* labels_above = (row > 0 ? labels_row - w : NULL);
+            int run_label = -1, last_x = -2;
+            for (int x : offsets) {
+                if (x != last_x + 1) {
+                    run_label = parent.size();
+                    parent.push_back(run_label);
+                }
+                labels_row[x] = run_label;
+                if (labels_above != NULL && labels_above[x] != -1) {
+                    union_find_join(parent, run_label, labels_above[x]);
+                }
+                last_x = x;
+            }
+        }
+
+        // Second pass: resolve to components, numbered in order of their first square
+        std::vector<int> component_of(parent.size(), -1);
+        for (int row = 0; row < h; row++) {
+            for (int x = 0; x < w; x++) {
+                int& label = labels[row * w + x];
+                if (label == -1) {
+                    continue;
+                }
+                int root = union_find_root(parent, label);
+                Pos xy(area.x1 + x, area.y1 + row);
+                if (component_of[root] == -1) {
+                    component_of[root] = components.components.size();
+                    MapComponent component = {0, BBox(xy, Size(1, 1)), xy};
+                    components.components.push_back(component);
+                }
+                label = component_of[root];
+                MapComponent& component = components.components[label];
+                component.size++;
+                component.bbox.x1 = std::min(component.bbox.x1, xy.x);
+                component.bbox.x2 = std::max(component.bbox.x2, xy.x + 1);
+                component.bbox.y2 = xy.y + 1;
+            }
+        }
+    }
+
+    void area_components_fill(Map& map, const MapComponents& components, int keep, Operator fill) {
+        const BBox& area = components.area;
+        int w = area.width();
+        for (int i = 0; i < (int)components.labels.size(); i++) {
+            int label = components.labels[i];
+            if (label != -1 && label != keep) {
+                map[Pos(area.x1 + i % w, area.y1 + i / w)].apply(fill);
+            }
+        }
+    }
 }
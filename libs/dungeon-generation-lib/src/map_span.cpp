@@ -0,0 +1,161 @@
+/*
+ * map_span.cpp:
+ *  Kernels that match & operate on runs of adjacent squares in a map row.
+ */
+
+#include <algorithm>
+
+#include "map_span.h"
+
+namespace ldungeon_gen {
+
+	// Squares tested per block before checking for an early exit
+	static const int SPAN_BLOCK = 64;
+
+	// Sets the values within 'range' to [min, min + span], returning false if there are none
+	static bool range_bounds(Range16 range, uint16_t& min, uint16_t& span) {
+		if (range.min > range.max) {
+			return false;
+		}
+		min = range.min, span = range.max - range.min;
+		return true;
+	}
+
+	/* A Selector as masks. A square matches when
+	 *   (flags & flag_mask) == flag_value, (content & content_mask) == content_value,
+	 *   group - group_min <= group_span, and not group - excluded_min <= excluded_span
+	 * with unsigned 16 bit arithmetic. */
+	struct SpanSelector {
+		uint16_t flag_mask, flag_value;
+		uint16_t content_mask, content_value;
+		uint16_t group_min, group_span;
+		uint16_t excluded_min, excluded_span;
+		bool has_excluded;
+
+		explicit SpanSelector(const Selector& selector) :
+				flag_mask(selector.must_be_on_bits | selector.must_be_off_bits),
+				flag_value(selector.must_be_on_bits),
+				content_mask(selector.use_must_be_content ? UNSET : 0),
+				content_value(selector.use_must_be_content ? selector.must_be_content : 0),
+				group_min(0), group_span(UNSET),
+				excluded_min(0), excluded_span(0), has_excluded(false) {
+			bool never = (selector.must_be_on_bits & selector.must_be_off_bits) != 0;
+			if (!Range16(selector.must_be_group).empty()) {
+				never |= !range_bounds(selector.must_be_group, group_min, group_span);
+			}
+			if (!Range16(selector.cant_be_group).empty()) {
+				has_excluded = range_bounds(selector.cant_be_group, excluded_min, excluded_span);
+			}
+			if (never) {
+				flag_mask = 0, flag_value = 1;
+			}
+		}
+
+		inline bool matches(const Square& sqr) const {
+			// Non-short-circuit '&' keeps this branch free
+			return ((sqr.flags & flag_mask) == flag_value)
+					& ((sqr.content & content_mask) == content_value)
+					& (uint16_t(sqr.group - group_min) <= group_span)
+					& (!has_excluded | (uint16_t(sqr.group - excluded_min) > excluded_span));
+		}
+	};
+
+	/* An Operator as masks, applied where 'mask' is all ones */
+	struct SpanOperator {
+		uint16_t flags_off, flags_on, flags_flip;
+		uint16_t content_keep, content_set;
+		uint16_t group_keep, group_set;
+
+		explicit SpanOperator(const Operator& oper) :
+				flags_off(oper.turn_off_bits), flags_on(oper.turn_on_bits), flags_flip(oper.flip_bits),
+				content_keep(oper.content_value == UNSET ? UNSET : 0),
+				content_set(oper.content_value == UNSET ? 0 : oper.content_value),
+				group_keep(oper.group_value == UNSET ? UNSET : 0),
+				group_set(oper.group_value == UNSET ? 0 : oper.group_value) {
+		}
+
+		inline void apply(Square& sqr, uint16_t mask) const {
+			uint16_t flags = ((sqr.flags & ~flags_off) | flags_on) ^ flags_flip;
+			uint16_t content = (sqr.content & content_keep) | content_set;
+			uint16_t group = (sqr.group & group_keep) | group_set;
+			sqr.flags = (sqr.flags & ~mask) | (flags & mask);
+			sqr.content = (sqr.content & ~mask) | (content & mask);
+			sqr.group = (sqr.group & ~mask) | (group & mask);
+		}
+	};
+
+	void span_apply(Square* row, int n, const Operator& oper) {
+		SpanOperator span_oper(oper);
+		for (int i = 0; i < n; i++) {
+			span_oper.apply(row[i], UNSET);
+		}
+	}
+
+	void span_apply(Square* row, int n, const ConditionalOperator& oper) {
+		SpanSelector selector(oper.selector);
+		SpanOperator span_oper(oper.oper);
+		for (int i = 0; i < n; i++) {
+			span_oper.apply(row[i], -uint16_t(selector.matches(row[i])));
+		}
+	}
+
+	bool span_all_match(const Square* row, int n, const Selector& selector) {
+		SpanSelector span_selector(selector);
+		for (int start = 0; start < n; start += SPAN_BLOCK) {
+			int end = std::min(n, start + SPAN_BLOCK);
+			bool all = true;
+			for (int i = start; i < end; i++) {
+				all &= span_selector.matches(row[i]);
+			}
+			if (!all) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Finds the first square where 'matches' holds, testing whole blocks first
+	template <typename Matches>
+	static int span_find(const Square* row, int n, Matches matches) {
+		for (int start = 0; start < n; start += SPAN_BLOCK) {
+			int end = std::min(n, start + SPAN_BLOCK);
+			bool any = false;
+			for (int i = start; i < end; i++) {
+				any |= matches(row[i]);
+			}
+			if (any) {
+				for (int i = start; i < end; i++) {
+					if (matches(row[i])) {
+						return i;
+					}
+				}
+			}
+		}
+		return -1;
+	}
+
+	int span_find_match(const Square* row, int n, const Selector& selector) {
+		SpanSelector span_selector(selector);
+		return span_find(row, n, [&](const Square& sqr) {
+			return span_selector.matches(sqr);
+		});
+	}
+
+	int span_find_match(const Square* row, int n, const Selector& selector,
+			const Selector& excluded) {
+		SpanSelector span_selector(selector), span_excluded(excluded);
+		return span_find(row, n, [&](const Square& sqr) {
+			return span_selector.matches(sqr) & !span_excluded.matches(sqr);
+		});
+	}
+
+	void span_collect_matches(const Square* row, int n, const Selector& selector,
+			std::vector<int>& offsets) {
+		SpanSelector span_selector(selector);
+		for (int i = 0; i < n; i++) {
+			if (span_selector.matches(row[i])) {
+				offsets.push_back(i);
+			}
+		}
+	}
+}
@@ -0,0 +1,92 @@
+/*
+ * region_spread.cpp:
+ *  Separates map regions with RVO steering, a native version of the
+ *  GenerateUtils.RVORegionPlacer loop used to lay out MapCompiler regions.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <rvo2/RVO.h>
+
+#include <lcommon/Timer.h>
+
+#include "region_spread.h"
+
+namespace ldungeon_gen {
+
+	// Same agent parameters as RVOWorld:add_instance
+	static const int MAX_NEIGHBOURS = 10;
+	static const float TIME_HORIZON = 2.0f, TIME_HORIZON_OBST = 1.0f;
+
+	static RegionSpreadStats stats = {0, 0, 0};
+
+	static int sign_of(double v) {
+		return v > 0 ? 1 : (v == 0 ? 0 : -1);
+	}
+
+	int region_spread(MTwist& rng, std::vector<SpreadRegion>& regions,
+			const RegionSpreadSettings& settings) {
+		Timer timer;
+		RVO::RVOSimulator sim;
+		for (SpreadRegion& r : regions) {
+			// Be conservative with the radius
+			double radius = ceil(std::max(r.w, r.h));
+			sim.addAgent(RVO::Vector2(r.x + r.w / 2, r.y + r.h / 2), radius * 2,
+					MAX_NEIGHBOURS, TIME_HORIZON, TIME_HORIZON_OBST, radius,
+					r.max_speed);
+		}
+
+		// Without random jitter, two still iterations in a row mean every later
+		// iteration starts from the same state
+		bool exact_fixed_point = (settings.mode != SPREAD_RANDOM);
+		bool was_still = false;
+		int iteration = 0;
+		while (iteration < settings.max_iterations) {
+			for (size_t i = 0; i < regions.size(); i++) {
+				SpreadRegion& r = regions[i];
+				double cx = floor(r.x + r.w / 2), cy = floor(r.y + r.h / 2);
+				double vx = 0, vy = 0;
+				if (settings.mode == SPREAD_RANDOM) {
+					vx = rng.rand(RangeF(-2, 2));
+					vy = rng.rand(RangeF(-2, 2));
+				} else {
+					vx = sign_of(settings.center_x - r.x) * 100;
+					vy = sign_of(settings.center_y - r.y) * 100;
+				}
+				sim.setAgentPosition(i, RVO::Vector2(cx, cy));
+				sim.setAgentRadius(i, ceil(std::min(r.w, r.h) / 2));
+				sim.setAgentMaxSpeed(i, r.max_speed);
+				sim.setAgentPrefVelocity(i, RVO::Vector2(vx, vy));
+			}
+			sim.doStep();
+			iteration++;
+
+			double max_movement = 0;
+			for (size_t i = 0; i < regions.size(); i++) {
+				RVO::Vector2 velocity = sim.getAgentVelocity(i);
+				regions[i].x += velocity.x();
+				regions[i].y += velocity.y();
+				max_movement = std::max(max_movement,
+						(double)std::max(fabs(velocity.x()), fabs(velocity.y())));
+			}
+			if (settings.converge_epsilon > 0 && max_movement < settings.converge_epsilon) {
+				break;
+			}
+			bool is_still = (max_movement == 0);
+			if (exact_fixed_point && is_still && was_still) {
+				break;
+			}
+			was_still = is_still;
+		}
+
+		stats.calls++;
+		stats.iterations += iteration;
+		stats.microseconds += timer.get_microseconds();
+		return iteration;
+	}
+
+	RegionSpreadStats region_spread_stats() {
+		return stats;
+	}
+}
@@ -0,0 +1,105 @@
+/*
+ * member_benchmark.cpp:
+ *  Measures the per-access cost of closure-bound luameta members vs fast
+ *  members, and of LuaValue creation. Run by hand, not part of the tests.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+#include <lua.hpp>
+
+#include <luawrap/luawrap.h>
+#include <luawrap/luameta.h>
+#include <luawrap/functions.h>
+#include <luawrap/members.h>
+#include <luawrap/types.h>
+#include <luawrap/testutils.h>
+
+struct SlowPoint {
+	float x;
+	int id;
+};
+
+struct FastPoint {
+	float x;
+	int id;
+};
+
+static LuaValue slowpoint_newmetatable(lua_State* L) {
+	LuaValue metatable = luameta_new(L, "SlowPoint");
+	LuaValue getters = luameta_getters(metatable);
+	LuaValue setters = luameta_setters(metatable);
+	luawrap::bind_getter(getters["x"], &SlowPoint::x);
+	luawrap::bind_setter(setters["x"], &SlowPoint::x);
+	luawrap::bind_getter(getters["id"], &SlowPoint::id);
+	return metatable;
+}
+
+static LuaValue fastpoint_newmetatable(lua_State* L) {
+	LuaValue metatable = luameta_new(L, "FastPoint");
+	LuaValue getters = luameta_getters(metatable);
+	LuaValue setters = luameta_setters(metatable);
+	LUAWRAP_FAST_GETTER(getters["x"], FastPoint, x);
+	LUAWRAP_FAST_SETTER(setters["x"], FastPoint, x);
+	LUAWRAP_FAST_GETTER(getters["id"], FastPoint, id);
+	return metatable;
+}
+
+static SlowPoint slowpoint_box(float x, int id) {
+	SlowPoint p = { x, id };
+	return p;
+}
+
+static FastPoint fastpoint_box(float x, int id) {
+	FastPoint p = { x, id };
+	return p;
+}
+
+static const int ACCESSES = 1000000;
+
+// Returns nanoseconds per 'x' read & write on the object created by 'box'
+static double time_member_access(lua_State* L, const char* box) {
+	char code[512];
+	snprintf(code, sizeof(code),
+			"local p = %s(0, 1)\n"
+			"for i = 1, %d do p.x = p.x + p.id end\n"
+			"assert(p.x == %d, 'member access sum')\n", box, ACCESSES / 2, ACCESSES / 2);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	lua_assert_valid_dostring(L, code);
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	// Each iteration does two reads & one write
+	return elapsed.count() / (ACCESSES / 2 * 3);
+}
+
+// Returns nanoseconds per LuaValue created from the stack, copied & read
+static double time_luavalue_creation(lua_State* L) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < ACCESSES; i++) {
+		lua_pushinteger(L, i);
+		LuaValue value = LuaValue::pop_value(L);
+		LuaValue copy = value;
+		if (copy.to_int() != i) {
+			throw std::runtime_error("LuaValue read back a different value");
+		}
+	}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / ACCESSES;
+}
+
+int main(int argc, char** argv) {
+	TestLuaState L;
+	luaL_openlibs(L);
+	luawrap::install_userdata_type<SlowPoint, slowpoint_newmetatable>();
+	luawrap::install_userdata_type<FastPoint, fastpoint_newmetatable>();
+	LuaValue globals(L, LUA_GLOBALSINDEX);
+	globals["slowpoint_box"].bind_function(slowpoint_box);
+	globals["fastpoint_box"].bind_function(fastpoint_box);
+
+	double slow_ns = time_member_access(L, "slowpoint_box");
+	double fast_ns = time_member_access(L, "fastpoint_box");
+	printf("luameta member access: closure %.1fns, fast %.1fns per access\n", slow_ns, fast_ns);
+	printf("LuaValue create, copy & read: %.1fns\n", time_luavalue_creation(L));
+	return 0;
+}
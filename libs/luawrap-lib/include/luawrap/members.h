@@ -44,6 +44,148 @@ namespace luawrap {
 	}
 
 	namespace _private {
+		/* Raises a Lua error for a member assigned a value of the wrong type.
+		 * Assumes the member name is at index 2. Defined in functions.cpp */
+		void __memberfail(lua_State* L, int idx, const char* expected_type);
+
+		/* Direct push & typechecked get for common member types, falls back to push/get. */
+		template<typename V>
+		struct FastValue {
+			static inline void push(lua_State* L, const V& value) {
+				luawrap::push<V>(L, value);
+			}
+			static inline void get(lua_State* L, int idx, V& value) {
+				luawrap::get<V>(L, idx, value);
+			}
+		};
+
+		/******************************************************************************
+		 * START AUTOGENERATED CODE -- Use 'generate-functions.py members'            *
+		 ******************************************************************************/
+		template<>
+		struct FastValue<int> {
+			static inline void push(lua_State* L, int value) {
+				lua_pushinteger(L, value);
+			}
+			static inline void get(lua_State* L, int idx, int& value) {
+				if (!lua_isnumber(L, idx)) {
+					__memberfail(L, idx, "int");
+				}
+				value = (int)lua_tointeger(L, idx);
+			}
+		};
+
+		template<>
+		struct FastValue<short> {
+			static inline void push(lua_State* L, short value) {
+				lua_pushinteger(L, value);
+			}
+			static inline void get(lua_State* L, int idx, short& value) {
+				if (!lua_isnumber(L, idx)) {
+					__memberfail(L, idx, "short");
+				}
+				value = (short)lua_tointeger(L, idx);
+			}
+		};
+
+		template<>
+		struct FastValue<long> {
+			static inline void push(lua_State* L, long value) {
+				lua_pushinteger(L, value);
+			}
+			static inline void get(lua_State* L, int idx, long& value) {
+				if (!lua_isnumber(L, idx)) {
+					__memberfail(L, idx, "long");
+				}
+				value = (long)lua_tointeger(L, idx);
+			}
+		};
+
+		template<>
+		struct FastValue<unsigned int> {
+			static inline void push(lua_State* L, unsigned int value) {
+				lua_pushnumber(L, value);
+			}
+			static inline void get(lua_State* L, int idx, unsigned int& value) {
+				if (!lua_isnumber(L, idx)) {
+					__memberfail(L, idx, "unsigned int");
+				}
+				value = (unsigned int)lua_tonumber(L, idx);
+			}
+		};
+
+		template<>
+		struct FastValue<unsigned short> {
+			static inline void push(lua_State* L, unsigned short value) {
+				lua_pushinteger(L, value);
+			}
+			static inline void get(lua_State* L, int idx, unsigned short& value) {
+				if (!lua_isnumber(L, idx)) {
+					__memberfail(L, idx, "unsigned short");
+				}
+				value = (unsigned short)lua_tointeger(L, idx);
+			}
+		};
+
+		template<>
+		struct FastValue<float> {
+			static inline void push(lua_State* L, float value) {
+				lua_pushnumber(L, value);
+			}
+			static inline void get(lua_State* L, int idx, float& value) {
+				if (!lua_isnumber(L, idx)) {
+					__memberfail(L, idx, "float");
+				}
+				value = (float)lua_tonumber(L, idx);
+			}
+		};
+
+		template<>
+		struct FastValue<double> {
+			static inline void push(lua_State* L, double value) {
+				lua_pushnumber(L, value);
+			}
+			static inline void get(lua_State* L, int idx, double& value) {
+				if (!lua_isnumber(L, idx)) {
+					__memberfail(L, idx, "double");
+				}
+				value = (double)lua_tonumber(L, idx);
+			}
+		};
+
+		template<>
+		struct FastValue<bool> {
+			static inline void push(lua_State* L, bool value) {
+				lua_pushboolean(L, value);
+			}
+			static inline void get(lua_State* L, int idx, bool& value) {
+				if (!lua_isboolean(L, idx)) {
+					__memberfail(L, idx, "bool");
+				}
+				value = (bool)lua_toboolean(L, idx);
+			}
+		};
+
+		/******************************************************************************
+		 * END AUTOGENERATED CODE                                                     *
+		 ******************************************************************************/
+
+		/* Member accessors called directly by luameta's __index & __newindex,
+		 * see bind_fast_getter & bind_fast_setter. */
+		template<typename T, typename V, V T::*member>
+		inline int fast_getter(lua_State* L) {
+			T& object = get<T&>(L, 1);
+			FastValue<V>::push(L, object.*member);
+			return 1;
+		}
+		template<typename T, typename V, V T::*member>
+		inline int fast_setter(lua_State* L) {
+			T& object = get<T&>(L, 1);
+			// 2nd arg is 'key'
+			FastValue<V>::get(L, 3, object.*member);
+			return 0;
+		}
+
 		template<typename T, typename V>
 		inline int getter(lua_State* L) {
 			typedef V T::* M;
@@ -83,6 +225,27 @@ namespace luawrap {
 		lua_pushcclosure(field.luastate(), luawrap::_private::setter<T, V>, 1);
 		field.pop();
 	}
+
+	/* Binds a member into a luameta getter table without creating a closure.
+	 * The accessor is stored as a light userdata that luameta calls directly
+	 * on lookup, so it can only be used in getter and setter tables. */
+	template<typename T, typename V, V T::*member, typename LuaWrapper>
+	void bind_fast_getter(const LuaWrapper& field) {
+		lua_pushlightuserdata(field.luastate(), (void*) &luawrap::_private::fast_getter<T, V, member>);
+		field.pop();
+	}
+
+	template<typename T, typename V, V T::*member, typename LuaWrapper>
+	void bind_fast_setter(const LuaWrapper& field) {
+		lua_pushlightuserdata(field.luastate(), (void*) &luawrap::_private::fast_setter<T, V, member>);
+		field.pop();
+	}
 }
 
+// Eg LUAWRAP_FAST_GETTER(getters["x"], GameInst, x)
+#define LUAWRAP_FAST_GETTER(field, T, member) \
+	luawrap::bind_fast_getter<T, decltype(T::member), &T::member>(field)
+#define LUAWRAP_FAST_SETTER(field, T, member) \
+	luawrap::bind_fast_setter<T, decltype(T::member), &T::member>(field)
+
 #endif /* LUAWRAP_MEMBERS_H_ */
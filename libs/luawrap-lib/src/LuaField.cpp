@@ -21,6 +21,7 @@
 #include <luawrap/LuaStackValue.h>
 
 #include "luawrapassert.h"
+#include "luavalue_impl.h"
 
 /*****************************************************************************
  *                          Constructors                                     *
@@ -222,8 +223,7 @@ void LuaField::push_parent() const {
 	if (_parent_type != FIELD_PARENT) {
 		/* Parent is not field */
 		if (_parent_type == REGISTRY_PARENT) {
-			lua_pushlightuserdata(L, _parent.registry);
-			lua_rawget(L, LUA_REGISTRYINDEX);
+			((const _luawrap_private::_LuaValueImpl*)_parent.registry)->push();
 		} else {
 			lua_pushvalue(L, _parent.stack_index);
 		}
@@ -10,61 +10,10 @@
 #include <luawrap/luawrap.h>
 
 #include "luawrapassert.h"
+#include "luavalue_impl.h"
 
 using namespace _luawrap_private;
 
-namespace _luawrap_private {
-
-	struct _LuaValueImpl {
-		_LuaValueImpl(lua_State* L) :
-				L(L), refcount(1) {
-		}
-		~_LuaValueImpl() {
-			if (L) {
-				clear();
-			}
-		}
-
-		void set(int pos) {
-			lua_pushvalue(L, pos); /*push value*/
-			int valueidx = lua_gettop(L);
-			lua_pushlightuserdata(L, this); /* push address as key */
-			lua_insert(L, -2);
-			lua_settable(L, LUA_REGISTRYINDEX);
-		}
-
-		void clear() {
-			lua_pushlightuserdata(L, this); /* push address as key */
-			lua_pushnil(L); /* push nil as value */
-			lua_settable(L, LUA_REGISTRYINDEX);
-			this->L = NULL;
-		}
-
-		void push() const {
-			lua_pushlightuserdata(L, (void*)this); /* push address as key */
-			lua_gettable(L, LUA_REGISTRYINDEX);
-		}
-
-		void pop() const {
-			int valueidx = lua_gettop(L);
-			lua_pushlightuserdata(L, (void*)this); /* push address as key */
-			lua_pushvalue(L, valueidx); /*Clone value*/
-			lua_settable(L, LUA_REGISTRYINDEX);
-
-			lua_pop(L, 1);
-			/*Pop value*/
-		}
-
-		bool is_uniquely_referenced() {
-			return refcount == 1;
-		}
-
-		lua_State* L;
-		size_t refcount;
-	};
-
-}
-
 static void deref(_LuaValueImpl* impl) {
 	if (impl && --impl->refcount == 0)
 		delete impl;
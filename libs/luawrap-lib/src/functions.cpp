@@ -30,5 +30,10 @@ namespace luawrap {
 					lstring.as<const char*>());
 			return false;
 		}
+
+		void __memberfail(lua_State* L, int idx, const char* expected_type) {
+			luaL_error(L, "Wrong type for member '%s', expected a %s but got a %s!",
+					lua_tostring(L, 2), expected_type, luaL_typename(L, idx));
+		}
 	}
 }
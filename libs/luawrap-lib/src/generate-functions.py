@@ -1,5 +1,7 @@
 #!/usr/bin/python
 
+import sys
+
 
 OVERLOAD = '''
 template<GENERATED_TEMPLATE_ARGS1>
@@ -46,4 +48,33 @@ for i in range(10):
     
     overloads.append(overload)
 
-print("\n".join(overloads))
+if sys.argv[1:] != ["members"]:
+    print("\n".join(overloads))
+
+
+# Typed member access, pasted into members.h. Run as 'generate-functions.py members'.
+FASTVALUE = '''
+template<>
+struct FastValue<{TYPE}> {{
+    static inline void push(lua_State* L, {TYPE} value) {{
+        {PUSH};
+    }}
+    static inline void get(lua_State* L, int idx, {TYPE}& value) {{
+        if (!{CHECK}) {{
+            __memberfail(L, idx, "{TYPE}");
+        }}
+        value = ({TYPE}){GET};
+    }}
+}};'''
+
+NUMBER = ("lua_pushnumber(L, value)", "lua_isnumber(L, idx)", "lua_tonumber(L, idx)")
+INTEGER = ("lua_pushinteger(L, value)", "lua_isnumber(L, idx)", "lua_tointeger(L, idx)")
+BOOLEAN = ("lua_pushboolean(L, value)", "lua_isboolean(L, idx)", "lua_toboolean(L, idx)")
+
+fast_types = [("int", INTEGER), ("short", INTEGER), ("long", INTEGER),
+              ("unsigned int", NUMBER), ("unsigned short", INTEGER),
+              ("float", NUMBER), ("double", NUMBER), ("bool", BOOLEAN)]
+
+if sys.argv[1:] == ["members"]:
+    for name, (push, check, get) in fast_types:
+        print(FASTVALUE.format(TYPE=name, PUSH=push, CHECK=check, GET=get))
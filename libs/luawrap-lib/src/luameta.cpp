@@ -17,7 +17,14 @@ static int luameta_get_member(lua_State* L) {
 	LUAWRAP_ASSERT(lua_gettop(L) == 2);
 
 	lua_pushvalue(L, 2); // key
-	lua_gettable(L, lua_upvalueindex(1)); // Push getter
+	lua_rawget(L, lua_upvalueindex(1)); // Push getter
+
+	// Member accessors bound with bind_fast_getter are called directly
+	if (lua_islightuserdata(L, -1)) {
+		lua_CFunction getter = (lua_CFunction) lua_touserdata(L, -1);
+		lua_pop(L, 1);
+		return getter(L);
+	}
 
 	// Check getter table
 	if (!lua_isnil(L, -1)) {
@@ -69,7 +76,14 @@ static int luameta_set_member(lua_State* L) {
 	LUAWRAP_ASSERT(lua_gettop(L) == 3);
 
 	lua_pushvalue(L, 2); // Push key
-	lua_gettable(L, lua_upvalueindex(1)); // Push setter
+	lua_rawget(L, lua_upvalueindex(1)); // Push setter
+
+	// Member accessors bound with bind_fast_setter are called directly
+	if (lua_islightuserdata(L, -1)) {
+		lua_CFunction setter = (lua_CFunction) lua_touserdata(L, -1);
+		lua_pop(L, 1);
+		return setter(L);
+	}
 
 	// Fallback to default setter (if one exists)
 
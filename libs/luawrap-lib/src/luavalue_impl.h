@@ -0,0 +1,74 @@
+/*
+ * luavalue_impl.h:
+ *  Shared state behind LuaValue copies. Holds an integer reference into the
+ *  registry, or none for nil.
+ */
+
+#ifndef LUAWRAP_LUAVALUE_IMPL_H_
+#define LUAWRAP_LUAVALUE_IMPL_H_
+
+#include <cstddef>
+
+#include <lua.hpp>
+
+namespace _luawrap_private {
+
+	struct _LuaValueImpl {
+		_LuaValueImpl(lua_State* L) :
+				L(L), refcount(1), ref(LUA_NOREF) {
+		}
+		~_LuaValueImpl() {
+			if (L) {
+				clear();
+			}
+		}
+
+		void set(int pos) {
+			lua_pushvalue(L, pos); /*push value*/
+			pop();
+		}
+
+		void clear() {
+			if (ref != LUA_NOREF) {
+				luaL_unref(L, LUA_REGISTRYINDEX, ref);
+				ref = LUA_NOREF;
+			}
+			this->L = NULL;
+		}
+
+		void push() const {
+			if (ref == LUA_NOREF) {
+				lua_pushnil(L);
+			} else {
+				lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+			}
+		}
+
+		/* Nil is represented by having no reference, as nil slots
+		 * in the registry would be handed out again by luaL_ref */
+		void pop() {
+			if (lua_isnil(L, -1)) {
+				lua_pop(L, 1);
+				if (ref != LUA_NOREF) {
+					luaL_unref(L, LUA_REGISTRYINDEX, ref);
+					ref = LUA_NOREF;
+				}
+			} else if (ref == LUA_NOREF) {
+				ref = luaL_ref(L, LUA_REGISTRYINDEX);
+			} else {
+				lua_rawseti(L, LUA_REGISTRYINDEX, ref);
+			}
+		}
+
+		bool is_uniquely_referenced() {
+			return refcount == 1;
+		}
+
+		lua_State* L;
+		size_t refcount;
+		int ref;
+	};
+
+}
+
+#endif /* LUAWRAP_LUAVALUE_IMPL_H_ */
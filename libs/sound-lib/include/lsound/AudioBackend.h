@@ -0,0 +1,40 @@
+/*
+ * AudioBackend.h:
+ *  The device that decodes and mixes sound effects. SDL_mixer is used
+ *  normally, while the null backend plays nothing, for headless runs & tests.
+ */
+
+#ifndef LSOUND_AUDIOBACKEND_H_
+#define LSOUND_AUDIOBACKEND_H_
+
+#include <string>
+#include <cstdlib>
+
+namespace lsound {
+
+	/* Decoded sample data, owned by the backend that decoded it */
+	typedef void* SampleHandle;
+
+	class AudioBackend {
+	public:
+		virtual ~AudioBackend() {
+		}
+
+		/* Called from the decoding thread. Returns NULL on failure. */
+		virtual SampleHandle decode(const std::string& filename,
+				size_t& bytes) = 0;
+		virtual void free_sample(SampleHandle sample) = 0;
+
+		virtual int n_channels() = 0;
+		/* Plays on the given channel, loops = -1 for looping forever */
+		virtual bool play(int channel, SampleHandle sample, int loops) = 0;
+		virtual void halt(int channel) = 0;
+		virtual bool is_playing(int channel) = 0;
+	};
+
+	AudioBackend* new_sdl_mixer_backend();
+	/* Voices stay 'playing' until halted, so voice limiting can be observed */
+	AudioBackend* new_null_backend(int nchannels);
+}
+
+#endif /* LSOUND_AUDIOBACKEND_H_ */
@@ -0,0 +1,123 @@
+/*
+ * SoundBank.h:
+ *  Owns the decoded data of every sound effect. Effects are decoded lazily on
+ *  a background thread, and the least recently played ones are evicted when
+ *  over the memory budget. Playback is voice limited: a sound steals the
+ *  channel of the oldest voice of lower or equal priority once all are busy.
+ *  Voices are only ever started from the main thread, in play() & update().
+ */
+
+#ifndef LSOUND_SOUNDBANK_H_
+#define LSOUND_SOUNDBANK_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+#include "AudioBackend.h"
+
+struct SDL_mutex;
+struct SDL_cond;
+struct SDL_Thread;
+
+namespace lsound {
+
+	struct SoundBankStats {
+		int decodes, evictions, plays, steals, dropped;
+		size_t bytes_loaded;
+	};
+
+	class SoundBank {
+	public:
+		enum {
+			DEFAULT_MEMORY_BUDGET = 32 * 1024 * 1024,
+			// Voices of a single sample before it steals from itself
+			DEFAULT_MAX_INSTANCES = 4,
+			// Plays requested before decoding finished are dropped if they
+			// have waited for longer than this many milliseconds
+			PENDING_PLAY_WINDOW = 250
+		};
+
+		/* Returns the current time in milliseconds */
+		typedef unsigned (*ClockFunc)();
+
+		SoundBank(ClockFunc clock = NULL);
+		~SoundBank();
+
+		/* Takes ownership, any previous backend is shut down */
+		void init(AudioBackend* backend);
+		void deinit();
+
+		/* Returns a stable sample id, shared by sounds of the same file */
+		int add(const std::string& filename, int priority);
+		void play(int sample, bool loop);
+		void stop_all();
+		/* Starts the plays that were waiting on a finished decode */
+		void update();
+
+		void set_memory_budget(size_t bytes);
+		void set_max_instances(int instances);
+		SoundBankStats stats();
+	private:
+		enum SampleState {
+			UNLOADED, DECODING, LOADED, FAILED
+		};
+		struct Sample {
+			std::string filename;
+			int priority;
+			SampleState state;
+			SampleHandle handle;
+			size_t bytes;
+			unsigned last_played;
+			int pending_loops; // -2 if no play is waiting on the decode
+			unsigned pending_since; // In milliseconds
+		};
+		struct Voice {
+			int sample;
+			int priority;
+			unsigned started;
+		};
+		struct Decoded {
+			int sample;
+			SampleHandle handle;
+			size_t bytes;
+		};
+
+		static int decode_thread(void* context);
+		void stop_decode_thread();
+		void decode_loop();
+
+		// Must be called with the lock held
+		void queue_decode(int sample);
+		void finish_decodes();
+		void finish_decode(int sample, SampleHandle handle, size_t bytes);
+		void start_voice(int sample, int loops);
+		int pick_channel(int sample);
+		bool is_voice_active(int channel);
+		void evict_over_budget(int keep);
+
+		AudioBackend* _backend;
+		std::vector<Sample> _samples;
+		std::map<std::string, int> _sample_ids;
+		std::vector<Voice> _voices;
+		std::deque<int> _decode_queue;
+		// Filled by the decoding thread, emptied on the main thread
+		std::vector<Decoded> _decoded;
+
+		size_t _memory_budget, _bytes_loaded;
+		int _max_instances;
+		unsigned _play_counter;
+		ClockFunc _clock;
+		SoundBankStats _stats;
+
+		SDL_mutex* _lock;
+		SDL_cond* _has_work;
+		SDL_Thread* _thread;
+		bool _quit;
+	};
+
+	SoundBank& sound_bank();
+}
+
+#endif /* LSOUND_SOUNDBANK_H_ */
@@ -7,16 +7,30 @@
 #define LSOUND_LSOUND_H_
 
 #include <string>
+#include <cstdlib>
 #include "Sound.h"
 
 namespace lsound {
+	/* Falls back to a silent backend if no audio device can be opened */
 	int init(int nchannels = 8);
+	/* Silent backend, for headless runs & tests */
+	void init_headless(int nchannels = 8);
 	void deinit();
 	void stop_music();
 	void stop_sounds();
+	/* Starts sounds whose decoding finished since the last call, once a frame */
+	void update();
+
+	/* Decoded sound effects past this size are evicted, least recently
+	 * played first. They are decoded again when next played. */
+	void set_sound_memory_budget(size_t bytes);
+	/* Voices a single sound effect can play on at once */
+	void set_sound_voice_limit(int voices);
 
 	Sound load_music(const std::string& filename);
-	Sound load_sound(const std::string& filename);
+	/* Decoding is started in the background, and the first play waits for it.
+	 * Higher priority sounds steal voices from lower priority ones. */
+	Sound load_sound(const std::string& filename, int priority = 0);
 }
 
 #endif /* LSOUND_LSOUND_H_ */
@@ -0,0 +1,92 @@
+/*
+ * AudioBackend.cpp:
+ *  The device that decodes and mixes sound effects. SDL_mixer is used
+ *  normally, while the null backend plays nothing, for headless runs & tests.
+ */
+
+#include <vector>
+#include <cstdio>
+
+#include <SDL_mixer.h>
+
+#include "AudioBackend.h"
+
+namespace lsound {
+
+	class SDLMixerBackend : public AudioBackend {
+	public:
+		virtual SampleHandle decode(const std::string& filename,
+				size_t& bytes) {
+			Mix_Chunk* chunk = Mix_LoadWAV(filename.c_str());
+			if (!chunk) {
+				printf("Music Error %s\n", Mix_GetError());
+				return NULL;
+			}
+			bytes = chunk->alen;
+			return chunk;
+		}
+		virtual void free_sample(SampleHandle sample) {
+			Mix_FreeChunk((Mix_Chunk*)sample);
+		}
+		virtual int n_channels() {
+			return Mix_AllocateChannels(-1);
+		}
+		virtual bool play(int channel, SampleHandle sample, int loops) {
+			return Mix_PlayChannel(channel, (Mix_Chunk*)sample, loops) != -1;
+		}
+		virtual void halt(int channel) {
+			Mix_HaltChannel(channel);
+		}
+		virtual bool is_playing(int channel) {
+			return Mix_Playing(channel) != 0;
+		}
+	};
+
+	class NullBackend : public AudioBackend {
+	public:
+		NullBackend(int nchannels) :
+				_playing(nchannels, false) {
+		}
+		virtual SampleHandle decode(const std::string& filename,
+				size_t& bytes) {
+			FILE* file = fopen(filename.c_str(), "rb");
+			if (!file) {
+				return NULL;
+			}
+			fseek(file, 0, SEEK_END);
+			bytes = ftell(file);
+			fclose(file);
+			return new size_t(bytes);
+		}
+		virtual void free_sample(SampleHandle sample) {
+			delete (size_t*)sample;
+		}
+		virtual int n_channels() {
+			return (int)_playing.size();
+		}
+		virtual bool play(int channel, SampleHandle sample, int loops) {
+			_playing.at(channel) = true;
+			return true;
+		}
+		virtual void halt(int channel) {
+			if (channel < 0) {
+				_playing.assign(_playing.size(), false);
+			} else {
+				_playing.at(channel) = false;
+			}
+		}
+		virtual bool is_playing(int channel) {
+			return _playing.at(channel);
+		}
+	private:
+		std::vector<bool> _playing;
+	};
+
+	AudioBackend* new_sdl_mixer_backend() {
+		return new SDLMixerBackend();
+	}
+
+	AudioBackend* new_null_backend(int nchannels) {
+		return new NullBackend(nchannels);
+	}
+}
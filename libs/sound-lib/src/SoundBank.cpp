@@ -0,0 +1,382 @@
+/*
+ * SoundBank.cpp:
+ *  Owns the decoded data of every sound effect. Effects are decoded lazily on
+ *  a background thread, and the least recently played ones are evicted when
+ *  over the memory budget. Playback is voice limited: a sound steals the
+ *  channel of the oldest voice of lower or equal priority once all are busy.
+ *  Voices are only ever started from the main thread, in play() & update().
+ */
+
+#include <cstdio>
+#include <algorithm>
+
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+#include <SDL_timer.h>
+
+#include "SoundBank.h"
+
+namespace lsound {
+
+	static unsigned sdl_ticks() {
+		return SDL_GetTicks();
+	}
+
+	SoundBank::SoundBank(ClockFunc clock) :
+			_backend(NULL),
+			_memory_budget(DEFAULT_MEMORY_BUDGET),
+			_bytes_loaded(0),
+			_max_instances(DEFAULT_MAX_INSTANCES),
+			_play_counter(0),
+			_clock(clock ? clock : sdl_ticks),
+			_thread(NULL),
+			_quit(false) {
+		_stats = SoundBankStats();
+		_lock = SDL_CreateMutex();
+		_has_work = SDL_CreateCond();
+	}
+
+	SoundBank::~SoundBank() {
+		// The audio device can be closed before static destruction, so any
+		// remaining samples are left to the OS rather than freed through it
+		stop_decode_thread();
+		SDL_DestroyMutex(_lock);
+		SDL_DestroyCond(_has_work);
+	}
+
+	void SoundBank::init(AudioBackend* backend) {
+		deinit();
+		_backend = backend;
+		Voice none = { -1, 0, 0 };
+		_voices.assign(_backend->n_channels(), none);
+		_quit = false;
+		_thread = SDL_CreateThread(decode_thread, "sound-decode-thread", this);
+		if (!_thread) {
+			// Eg, no thread support; decode on the calling thread instead
+			printf("Sound bank: decoding on the main thread: %s\n",
+					SDL_GetError());
+		}
+	}
+
+	void SoundBank::deinit() {
+		stop_decode_thread();
+		if (!_backend) {
+			return;
+		}
+		_backend->halt(-1);
+		for (int i = 0; i < _decoded.size(); i++) {
+			if (_decoded[i].handle) {
+				_backend->free_sample(_decoded[i].handle);
+			}
+		}
+		_decoded.clear();
+		for (int i = 0; i < _samples.size(); i++) {
+			Sample& s = _samples[i];
+			if (s.state == LOADED) {
+				_backend->free_sample(s.handle);
+			}
+			s.state = UNLOADED;
+			s.handle = NULL;
+			s.bytes = 0;
+			s.pending_loops = -2;
+		}
+		_decode_queue.clear();
+		_voices.clear();
+		_bytes_loaded = 0;
+		delete _backend;
+		_backend = NULL;
+	}
+
+	int SoundBank::add(const std::string& filename, int priority) {
+		SDL_LockMutex(_lock);
+		int id;
+		std::map<std::string, int>::iterator it = _sample_ids.find(filename);
+		if (it != _sample_ids.end()) {
+			id = it->second;
+			Sample& s = _samples[id];
+			s.priority = std::max(s.priority, priority);
+		} else {
+			id = (int)_samples.size();
+			Sample s = { filename, priority, UNLOADED, NULL, 0, 0, -2, 0 };
+			_samples.push_back(s);
+			_sample_ids[filename] = id;
+			// Start decoding ahead of the first play
+			if (_backend) {
+				queue_decode(id);
+			}
+		}
+		SDL_UnlockMutex(_lock);
+		return id;
+	}
+
+	void SoundBank::play(int sample, bool loop) {
+		SDL_LockMutex(_lock);
+		if (!_backend) {
+			SDL_UnlockMutex(_lock);
+			return;
+		}
+		finish_decodes();
+		int loops = loop ? -1 : 0;
+		Sample& s = _samples.at(sample);
+		s.last_played = ++_play_counter;
+		_stats.plays++;
+		switch (s.state) {
+		case LOADED:
+			start_voice(sample, loops);
+			break;
+		case FAILED:
+			_stats.dropped++;
+			break;
+		case UNLOADED:
+		case DECODING:
+			// Played once decoded, unless it has been waiting too long
+			s.pending_loops = loops;
+			s.pending_since = _clock();
+			if (s.state == UNLOADED) {
+				queue_decode(sample);
+			}
+			break;
+		}
+		SDL_UnlockMutex(_lock);
+	}
+
+	void SoundBank::update() {
+		SDL_LockMutex(_lock);
+		if (_backend) {
+			finish_decodes();
+		}
+		SDL_UnlockMutex(_lock);
+	}
+
+	void SoundBank::stop_all() {
+		SDL_LockMutex(_lock);
+		if (_backend) {
+			_backend->halt(-1);
+		}
+		for (int i = 0; i < _voices.size(); i++) {
+			_voices[i].sample = -1;
+		}
+		SDL_UnlockMutex(_lock);
+	}
+
+	void SoundBank::set_memory_budget(size_t bytes) {
+		SDL_LockMutex(_lock);
+		_memory_budget = bytes;
+		evict_over_budget(-1);
+		SDL_UnlockMutex(_lock);
+	}
+
+	void SoundBank::set_max_instances(int instances) {
+		SDL_LockMutex(_lock);
+		_max_instances = std::max(1, instances);
+		SDL_UnlockMutex(_lock);
+	}
+
+	SoundBankStats SoundBank::stats() {
+		SDL_LockMutex(_lock);
+		SoundBankStats stats = _stats;
+		stats.bytes_loaded = _bytes_loaded;
+		SDL_UnlockMutex(_lock);
+		return stats;
+	}
+
+	int SoundBank::decode_thread(void* context) {
+		((SoundBank*)context)->decode_loop();
+		return 0;
+	}
+
+	void SoundBank::stop_decode_thread() {
+		if (!_thread) {
+			return;
+		}
+		SDL_LockMutex(_lock);
+		_quit = true;
+		SDL_CondSignal(_has_work);
+		SDL_UnlockMutex(_lock);
+		SDL_WaitThread(_thread, NULL);
+		_thread = NULL;
+	}
+
+	void SoundBank::decode_loop() {
+		SDL_LockMutex(_lock);
+		while (!_quit) {
+			if (_decode_queue.empty()) {
+				SDL_CondWait(_has_work, _lock);
+				continue;
+			}
+			int sample = _decode_queue.front();
+			_decode_queue.pop_front();
+			std::string filename = _samples[sample].filename;
+
+			// Decode without blocking playback on the main thread
+			SDL_UnlockMutex(_lock);
+			size_t bytes = 0;
+			SampleHandle handle = _backend->decode(filename, bytes);
+			SDL_LockMutex(_lock);
+
+			// Voices are started on the main thread, see finish_decodes()
+			Decoded decoded = { sample, handle, bytes };
+			_decoded.push_back(decoded);
+		}
+		SDL_UnlockMutex(_lock);
+	}
+
+	void SoundBank::queue_decode(int sample) {
+		_samples[sample].state = DECODING;
+		if (_thread) {
+			_decode_queue.push_back(sample);
+			SDL_CondSignal(_has_work);
+		} else {
+			size_t bytes = 0;
+			SampleHandle handle = _backend->decode(_samples[sample].filename,
+					bytes);
+			finish_decode(sample, handle, bytes);
+		}
+	}
+
+	void SoundBank::finish_decodes() {
+		for (int i = 0; i < _decoded.size(); i++) {
+			Decoded& d = _decoded[i];
+			finish_decode(d.sample, d.handle, d.bytes);
+		}
+		_decoded.clear();
+	}
+
+	void SoundBank::finish_decode(int sample, SampleHandle handle,
+			size_t bytes) {
+		Sample& s = _samples[sample];
+		int pending_loops = s.pending_loops;
+		s.pending_loops = -2;
+		_stats.decodes++;
+		if (!handle) {
+			s.state = FAILED;
+			return;
+		}
+		s.state = LOADED;
+		s.handle = handle;
+		s.bytes = bytes;
+		_bytes_loaded += bytes;
+
+		if (pending_loops != -2) {
+			if (_clock() - s.pending_since <= PENDING_PLAY_WINDOW) {
+				start_voice(sample, pending_loops);
+			} else {
+				_stats.dropped++;
+			}
+		}
+		evict_over_budget(sample);
+	}
+
+	void SoundBank::start_voice(int sample, int loops) {
+		int channel = pick_channel(sample);
+		if (channel == -1) {
+			_stats.dropped++;
+			return;
+		}
+		if (is_voice_active(channel)) {
+			_backend->halt(channel);
+			_stats.steals++;
+		}
+		Sample& s = _samples[sample];
+		if (_backend->play(channel, s.handle, loops)) {
+			Voice voice = { sample, s.priority, _play_counter };
+			_voices[channel] = voice;
+		} else {
+			_voices[channel].sample = -1;
+			_stats.dropped++;
+		}
+	}
+
+	// Lower priority first, then the oldest
+	static bool steal_before(int priority1, unsigned started1, int priority2,
+			unsigned started2) {
+		if (priority1 != priority2) {
+			return priority1 < priority2;
+		}
+		return started1 < started2;
+	}
+
+	int SoundBank::pick_channel(int sample) {
+		int priority = _samples[sample].priority;
+		int instances = 0, oldest_instance = -1;
+		int free_channel = -1, victim = -1;
+
+		for (int channel = 0; channel < _voices.size(); channel++) {
+			if (!is_voice_active(channel)) {
+				if (free_channel == -1) {
+					free_channel = channel;
+				}
+				continue;
+			}
+			Voice& v = _voices[channel];
+			if (v.sample == sample) {
+				instances++;
+				if (oldest_instance == -1
+						|| v.started < _voices[oldest_instance].started) {
+					oldest_instance = channel;
+				}
+			}
+			if (v.priority <= priority
+					&& (victim == -1
+							|| steal_before(v.priority, v.started,
+									_voices[victim].priority,
+									_voices[victim].started))) {
+				victim = channel;
+			}
+		}
+
+		if (instances >= _max_instances) {
+			return oldest_instance;
+		}
+		if (free_channel != -1) {
+			return free_channel;
+		}
+		return victim;
+	}
+
+	bool SoundBank::is_voice_active(int channel) {
+		Voice& v = _voices[channel];
+		if (v.sample != -1 && !_backend->is_playing(channel)) {
+			v.sample = -1;
+		}
+		return v.sample != -1;
+	}
+
+	void SoundBank::evict_over_budget(int keep) {
+		while (_bytes_loaded > _memory_budget) {
+			int lru = -1;
+			for (int i = 0; i < _samples.size(); i++) {
+				Sample& s = _samples[i];
+				if (i == keep || s.state != LOADED
+						|| (lru != -1 && s.last_played >= _samples[lru].last_played)) {
+					continue;
+				}
+				bool playing = false;
+				for (int channel = 0; channel < _voices.size(); channel++) {
+					if (_voices[channel].sample == i && is_voice_active(channel)) {
+						playing = true;
+						break;
+					}
+				}
+				if (!playing) {
+					lru = i;
+				}
+			}
+			if (lru == -1) {
+				break;
+			}
+			Sample& s = _samples[lru];
+			_backend->free_sample(s.handle);
+			_bytes_loaded -= s.bytes;
+			s.state = UNLOADED;
+			s.handle = NULL;
+			s.bytes = 0;
+			_stats.evictions++;
+		}
+	}
+
+	SoundBank& sound_bank() {
+		static SoundBank bank;
+		return bank;
+	}
+}
@@ -3,60 +3,48 @@
  *  Represents a sound effect, multiple can be played at a time.
  */
 
-#include <SDL_mixer.h>
-
 #include "SoundEffect.h"
+#include "SoundBank.h"
 #include "Sound.h"
 
-/* Controls the smart pointer deletion */
-static void __freesound_callback(void* mm) {
-	Mix_FreeChunk((Mix_Chunk*)mm);
-}
-
 namespace lsound {
 
-	SoundEffect::SoundEffect() {
+	SoundEffect::SoundEffect() :
+			_sample(-1) {
 	}
 
 	SoundEffect::~SoundEffect() {
 	}
 
-	SoundEffect::SoundEffect(const std::string& filename) {
-		init(filename);
+	SoundEffect::SoundEffect(const std::string& filename, int priority) :
+			_sample(-1) {
+		init(filename, priority);
 	}
 
-	void SoundEffect::init(const std::string& filename) {
-		Mix_Chunk* snd = Mix_LoadWAV(filename.c_str());
-		clear();
-		if (snd) {
-			_soundeffect = smartptr<Mix_Chunk>(snd, __freesound_callback);
-		}
+	void SoundEffect::init(const std::string& filename, int priority) {
+		_sample = sound_bank().add(filename, priority);
 	}
 
 	void SoundEffect::play() const {
-		if (_soundeffect) {
-			Mix_PlayChannel(-1, _soundeffect.get(), 0);
-		} else {
-                        printf("Music Error %s\n",Mix_GetError());
-                }
+		if (_sample != -1) {
+			sound_bank().play(_sample, false);
+		}
 	}
 	void SoundEffect::clear() {
-		_soundeffect = smartptr<Mix_Chunk>();
+		_sample = -1;
 	}
 
 	bool SoundEffect::empty() const {
-		return _soundeffect.empty();
+		return _sample == -1;
 	}
 
 	void SoundEffect::loop() const {
-		if (_soundeffect) {
-			Mix_PlayChannel(-1, _soundeffect.get(), -1);
-		} else {
-                        printf("Music Error %s\n",Mix_GetError());
-                }
+		if (_sample != -1) {
+			sound_bank().play(_sample, true);
+		}
 	}
 
-	Sound load_sound(const std::string& filename) {
-		return Sound(new SoundEffect(filename));
+	Sound load_sound(const std::string& filename, int priority) {
+		return Sound(new SoundEffect(filename, priority));
 	}
 }
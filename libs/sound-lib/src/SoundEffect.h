@@ -1,6 +1,7 @@
 /*
  * SoundEffect.h:
  *  Represents a sound effect, multiple can be played at a time.
+ *  The decoded data is held by the sound bank, which decodes it lazily.
  */
 
 #ifndef LSOUND_SOUNDEFFECT_H_
@@ -8,21 +9,19 @@
 
 #include <string>
 #include <cstdio>
-#include <lcommon/smartptr.h>
 
 #include <SoundBase.h>
 
-struct Mix_Chunk;
-
 namespace lsound {
 
 	class SoundEffect : public SoundBase {
 	public:
 		SoundEffect();
 		~SoundEffect();
-		SoundEffect(const std::string& filename);
+		/* Higher priority sounds steal voices from lower priority ones */
+		SoundEffect(const std::string& filename, int priority = 0);
 
-		void init(const std::string& filename);
+		void init(const std::string& filename, int priority = 0);
 
 		/* Clear the reference*/
 		void clear();
@@ -32,7 +31,7 @@ namespace lsound {
 		virtual void play() const;
 		virtual void loop() const;
 	private:
-		smartptr<Mix_Chunk> _soundeffect;
+		int _sample; // Sound bank id, -1 if empty
 	};
 
 }
@@ -8,6 +8,8 @@
 #include <SDL_mixer.h>
 
 #include "lsound.h"
+#include "AudioBackend.h"
+#include "SoundBank.h"
 
 namespace lsound {
 	int init(int nchannels) {
@@ -26,24 +28,47 @@ namespace lsound {
 				audio_buffers);
                 if (mixcode == -1) {
                         printf("Music Error: Unable to open audio: %s\n", SDL_GetError());
+			init_headless(nchannels);
 			return mixcode;
 		}
 		mixcode = Mix_AllocateChannels(nchannels);
                 if( mixcode < 0 )
                 {
                     printf("Music Error: Unable to allocate mixing channels: %s\n", SDL_GetError());
+                    init_headless(nchannels);
                     return mixcode;
                 }
 
+		sound_bank().init(new_sdl_mixer_backend());
 		return 0;
 	}
 
-	void deinit() {
+	void init_headless(int nchannels) {
+		sound_bank().init(new_null_backend(nchannels));
+	}
 
+	void deinit() {
+		sound_bank().deinit();
 		Mix_CloseAudio();
 	}
 
 	void stop_music() {
 		Mix_HaltMusic();
 	}
+
+	void stop_sounds() {
+		sound_bank().stop_all();
+	}
+
+	void update() {
+		sound_bank().update();
+	}
+
+	void set_sound_memory_budget(size_t bytes) {
+		sound_bank().set_memory_budget(bytes);
+	}
+
+	void set_sound_voice_limit(int voices) {
+		sound_bank().set_max_instances(voices);
+	}
 }
@@ -25,6 +25,13 @@ static void clear(Sound& snd) {
 	snd.clear();
 }
 
+// sound_load(filename, [priority]), higher priority sounds steal voices
+static int sound_load(lua_State* L) {
+	int priority = (lua_gettop(L) >= 2) ? luaL_checkinteger(L, 2) : 0;
+	luawrap::push(L, load_sound(luaL_checkstring(L, 1), priority));
+	return 1;
+}
+
 LuaValue lua_soundmetatable(lua_State* L) {
 	LuaValue meta = luameta_new(L, "Sound");
 	LuaValue methods = luameta_constants(meta);
@@ -50,7 +57,7 @@ void lua_register_lsound(lua_State* L, const LuaModule& module) {
 	luawrap::install_userdata_type<Sound, lua_soundmetatable>();
 
 	module.values["music_load"].bind_function(load_music);
-	module.values["sound_load"].bind_function(load_sound);
+	module.values["sound_load"].bind_function(sound_load);
 	module.setters["sound_volume"].bind_function(set_volume);
 	module.getters["sound_volume"].bind_function(get_volume);
 }
@@ -7,6 +7,8 @@ require_path_add('dependencies/socket/?.lua')
 
 require("GlobalVariableSetup")(--[[Load draw-related globals]] os.getenv("LANARTS_HEADLESS") ~= nil)
 require("moonscript.base").insert_loader()
+-- Load modules from compiled bytecode when their source is unchanged
+require("core.ChunkCache").insert_loader()
 
 local argv -- Placeholder, set in main()
 
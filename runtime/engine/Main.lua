@@ -15,6 +15,8 @@ require("GlobalVariableSetup")(--[[Surpress loading draw-related globals?]] os.g
 
 -- (4) Ensure moonscript loading is inserted
 require("moonscript.base").insert_loader()
+-- Load modules from compiled bytecode when their source is unchanged
+require("core.ChunkCache").insert_loader()
 
 -- Default usage:
 --   On normal desktop play: ./lanarts engine.StartLanarts *args*
@@ -6,11 +6,14 @@
 #include <lcommon/PerfTimer.h>
 #include <rvo2/RVO.h>
 
+#include "gamestate/GameTiles.h"
 #include "objects/CombatGameInst.h"
+#include "util/worker_pool.h"
 
 #include "CollisionAvoidance.h"
 
 CollisionAvoidance::CollisionAvoidance() {
+	walls_version = -1;
 	simulator = new RVO::RVOSimulator();
 	simulator->setTimeStep(1.0f);
 }
@@ -55,7 +58,8 @@ simul_id CollisionAvoidance::add_player_object(CombatGameInst* inst) {
 	RVO::Vector2 enemy_position(inst->x, inst->y);
 	EffectiveStats& estats = inst->effective_stats();
 
-	return (simul_id)simulator->addAgent(enemy_position, 0, 10, 0.0f, 0.0f, inst->radius,
+	// Non-zero obstacle horizon, players do not move but can still touch walls
+	return (simul_id)simulator->addAgent(enemy_position, 0, 10, 0.0f, 1.0f, inst->radius,
 			0);
 }
 
@@ -76,9 +80,18 @@ void CollisionAvoidance::set_maxspeed(simul_id id, float maxspeed) {
 	simulator->setAgentMaxSpeed(id, maxspeed);
 }
 
+// Below this many agents per thread the synchronization costs more than it saves
+static const size_t MIN_AGENTS_PER_THREAD = 64;
+
+static void run_on_worker_pool(void* pool, size_t n, RVO::ParallelRange range, void* data) {
+	((WorkerPool*)pool)->parallel_for(n, range, data, MIN_AGENTS_PER_THREAD);
+}
+
 void CollisionAvoidance::step() {
 	perf_timer_begin(FUNCNAME);
-	simulator->doStep();
+	// Agents only write their own state in each pass, so this is deterministic
+	// regardless of how many threads the pool has
+	simulator->doStep(run_on_worker_pool, &worker_pool());
 	perf_timer_end(FUNCNAME);
 }
 
@@ -88,6 +101,129 @@ PosF CollisionAvoidance::get_position(simul_id id) {
 }
 
 void CollisionAvoidance::clear() {
+	walls_version = -1;
+	delete simulator;
 	simulator = new RVO::RVOSimulator();
 	simulator->setTimeStep(1.0f);
 }
+
+// A unit edge between a solid and a passable tile, directed so that
+// the solid side is on the left as RVO sees it (rotating dir by +90 degrees)
+struct WallEdge {
+	Pos from, dir;
+	bool used;
+};
+
+static bool is_passable(const Grid<bool>& solidity, int x, int y) {
+	Size size = solidity.size();
+	// Outside the map counts as solid
+	return x >= 0 && y >= 0 && x < size.w && y < size.h && !solidity[Pos(x, y)];
+}
+
+// Traces the walls into closed outlines of tile corners, one per boundary
+// between a solid and a passable region, keeping only the corner points
+static void trace_wall_outlines(const Grid<bool>& solidity,
+		std::vector< std::vector<Pos> >& outlines) {
+	Size size = solidity.size();
+	std::vector<WallEdge> edges;
+	// Includes the solid border around the map, which passable border tiles touch
+	for (int y = -1; y <= size.h; y++) {
+		for (int x = -1; x <= size.w; x++) {
+			if (is_passable(solidity, x, y)) {
+				continue;
+			}
+			if (is_passable(solidity, x, y - 1)) {
+				edges.push_back({Pos(x, y), Pos(1, 0), false});
+			}
+			if (is_passable(solidity, x + 1, y)) {
+				edges.push_back({Pos(x + 1, y), Pos(0, 1), false});
+			}
+			if (is_passable(solidity, x, y + 1)) {
+				edges.push_back({Pos(x + 1, y + 1), Pos(-1, 0), false});
+			}
+			if (is_passable(solidity, x - 1, y)) {
+				edges.push_back({Pos(x, y + 1), Pos(0, -1), false});
+			}
+		}
+	}
+
+	// Corners run from -1 to the size + 1. At most two edges leave a corner,
+	// when two solid tiles touch diagonally.
+	int stride = size.w + 3;
+	std::vector<int> first_out((size.h + 3) * stride, -1), second_out(first_out.size(), -1);
+	for (int i = 0; i < edges.size(); i++) {
+		int corner = (edges[i].from.y + 1) * stride + edges[i].from.x + 1;
+		(first_out[corner] == -1 ? first_out[corner] : second_out[corner]) = i;
+	}
+
+	for (int start = 0; start < edges.size(); start++) {
+		if (edges[start].used) {
+			continue;
+		}
+		std::vector<Pos> outline;
+		int edge = start;
+		// Each edge has one successor, so the outlines are disjoint cycles
+		while (!edges[edge].used) {
+			WallEdge& current = edges[edge];
+			current.used = true;
+			Pos to(current.from.x + current.dir.x, current.from.y + current.dir.y);
+			int corner = (to.y + 1) * stride + to.x + 1;
+			// Where solid tiles touch diagonally, hug the solid tile
+			int next = first_out[corner], other = second_out[corner];
+			if (other != -1 && edges[other].dir == Pos(-current.dir.y, current.dir.x)) {
+				next = other;
+			}
+			if (edges[next].dir != current.dir) {
+				outline.push_back(to);
+			}
+			edge = next;
+		}
+		if (outline.size() >= 2) {
+			outlines.push_back(outline);
+		}
+	}
+}
+
+void CollisionAvoidance::update_walls(GameTiles& tiles) {
+	if (tiles.solidity_version() == walls_version) {
+		return;
+	}
+	perf_timer_begin(FUNCNAME);
+	walls_version = tiles.solidity_version();
+
+	std::vector< std::vector<Pos> > outlines;
+	trace_wall_outlines(*tiles.solidity_map(), outlines);
+
+	// RVO has no obstacle removal, so changes rebuild the wall set
+	simulator->clearObstacles();
+	for (int i = 0; i < outlines.size(); i++) {
+		std::vector<RVO::Vector2> vertices;
+		for (int j = 0; j < outlines[i].size(); j++) {
+			vertices.push_back(RVO::Vector2(outlines[i][j].x * TILE_SIZE,
+					outlines[i][j].y * TILE_SIZE));
+		}
+		simulator->addObstacle(vertices);
+	}
+	simulator->processObstacles();
+	perf_timer_end(FUNCNAME);
+}
+
+// Removed slots are reused lowest first, so only compact once they dominate
+static const size_t MIN_FREE_SLOTS_TO_COMPACT = 256;
+
+bool CollisionAvoidance::wants_compaction() const {
+	size_t n_live = simulator->getNumLiveAgents();
+	size_t n_free = simulator->getNumAgents() - n_live;
+	return n_free >= MIN_FREE_SLOTS_TO_COMPACT && n_free > n_live;
+}
+
+void CollisionAvoidance::compact(std::vector<simul_id>& remap) {
+	perf_timer_begin(FUNCNAME);
+	std::vector<size_t> agent_remap;
+	simulator->compactAgents(agent_remap);
+	remap.resize(agent_remap.size());
+	for (size_t i = 0; i < agent_remap.size(); i++) {
+		remap[i] = agent_remap[i] == RVO::RVO_ERROR ? -1 : (simul_id)agent_remap[i];
+	}
+	perf_timer_end(FUNCNAME);
+}
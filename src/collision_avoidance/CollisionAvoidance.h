@@ -12,6 +12,7 @@
 #include "lanarts_defines.h"
 
 class CombatGameInst;
+class GameTiles;
 
 namespace RVO {
 struct RVOSimulator;
@@ -38,8 +39,19 @@ public:
 	void step();
 	void clear();
 
+	/* Rebuilds the wall obstacles if tile solidity changed since the last call */
+	void update_walls(GameTiles& tiles);
+
+	/* True once enough objects were removed that compact() is worthwhile */
+	bool wants_compaction() const;
+	/* Renumbers the objects densely, keeping their order. 'remap' maps
+	 * each old id to its new id, or -1 for removed objects. */
+	void compact(std::vector<simul_id>& remap);
+
 private:
 	RVO::RVOSimulator* simulator;
+	// GameTiles::solidity_version() the walls were built from, -1 if none
+	int walls_version;
 };
 
 #endif /* COLLISIONAVOIDANCE_H_ */
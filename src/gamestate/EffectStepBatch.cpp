@@ -0,0 +1,97 @@
+/*
+ * EffectStepBatch.cpp:
+ *  Groups the active effects whose entry defines step_batch_func, so that
+ *  each effect type is stepped with one Lua call per frame for the whole
+ *  level instead of calling step_func per object. The arrays passed to Lua
+ *  are reused between frames.
+ */
+
+#include <lcommon/perf_timer.h>
+#include <luawrap/luawrap.h>
+
+#include "objects/GameInst.h"
+#include "stats/effects.h"
+
+#include "EffectStepBatch.h"
+
+void EffectStepBatch::begin() {
+	_active = true;
+	for (int i = 0; i < _groups.size(); i++) {
+		_groups[i].effect_states.clear();
+		_groups[i].insts.clear();
+	}
+}
+
+bool EffectStepBatch::add(GameInst* inst, Effect& eff) {
+	EffectEntry& entry = eff.entry();
+	if (!_active || entry.step_batch_func.empty() || entry.step_batch_func.isnil()) {
+		return false;
+	}
+	Group* group = NULL;
+	for (int i = 0; i < _groups.size() && group == NULL; i++) {
+		if (_groups[i].id == eff.id) {
+			group = &_groups[i];
+		}
+	}
+	if (group == NULL) {
+		_groups.push_back(Group());
+		group = &_groups.back();
+		group->id = eff.id;
+		group->states = LuaValue::newtable(eff.state.luastate());
+		group->objects = LuaValue::newtable(eff.state.luastate());
+	}
+	group->effect_states.push_back(eff.state);
+	group->insts.push_back(inst);
+	return true;
+}
+
+void EffectStepBatch::dispatch(lua_State* L) {
+	perf_timer_begin(FUNCNAME);
+	_active = false;
+	for (int i = 0; i < _groups.size(); i++) {
+		Group& group = _groups[i];
+		std::vector<GameInst*>& insts = group.insts;
+		if (insts.empty()) {
+			continue;
+		}
+
+		group.states.push();
+		int states_idx = lua_gettop(L);
+		group.objects.push();
+		int objects_idx = lua_gettop(L);
+		int n = 0;
+		for (int j = 0; j < insts.size(); j++) {
+			// Removed during the step, by another object
+			if (insts[j]->destroyed) {
+				continue;
+			}
+			n++;
+			group.effect_states[j].push();
+			lua_rawseti(L, states_idx, n);
+			luawrap::push(L, insts[j]);
+			lua_rawseti(L, objects_idx, n);
+		}
+		if (n > 0) {
+			game_effect_data.get(group.id).step_batch_func.push();
+			lua_pushvalue(L, states_idx);
+			lua_pushvalue(L, objects_idx);
+			lua_call(L, 2, 0);
+		}
+		// Clear the arrays, so they do not keep objects & states alive
+		for (int j = 1; j <= n; j++) {
+			lua_pushnil(L);
+			lua_rawseti(L, states_idx, j);
+			lua_pushnil(L);
+			lua_rawseti(L, objects_idx, j);
+		}
+		group.effect_states.clear();
+		insts.clear();
+		lua_settop(L, states_idx - 1);
+	}
+	perf_timer_end(FUNCNAME);
+}
+
+void EffectStepBatch::clear() {
+	_active = false;
+	_groups.clear();
+}
@@ -0,0 +1,54 @@
+/*
+ * EffectStepBatch.h:
+ *  Groups the active effects whose entry defines step_batch_func, so that
+ *  each effect type is stepped with one Lua call per frame for the whole
+ *  level instead of calling step_func per object. The arrays passed to Lua
+ *  are reused between frames.
+ *
+ *  This moves when such effects step. A step_func runs inside its owner's
+ *  step, while a batched effect runs once every object of the level has
+ *  stepped (see GameInstSet::step). So poison damage and aura buffs land after
+ *  all of the level's objects have acted that frame, and objects that step
+ *  after an aura's owner see its buff one frame later than before. The order
+ *  is the same for all network peers: by effect type first seen, then by the
+ *  order the owners stepped in. Objects destroyed during the step are skipped.
+ */
+
+#ifndef EFFECTSTEPBATCH_H_
+#define EFFECTSTEPBATCH_H_
+
+#include <vector>
+
+#include <luawrap/LuaValue.h>
+
+#include "lanarts_defines.h"
+
+class GameInst;
+struct Effect;
+
+class EffectStepBatch {
+public:
+	EffectStepBatch() :
+			_active(false) {
+	}
+
+	/* Between begin() and dispatch(), batched effects are collected
+	 * instead of stepped */
+	void begin();
+	/* Returns false if 'eff' should run its own step_func */
+	bool add(GameInst* inst, Effect& eff);
+	/* Calls step_batch_func(states, objects) once per effect type */
+	void dispatch(lua_State* L);
+	void clear();
+private:
+	struct Group {
+		effect_id id;
+		LuaValue states, objects; // Reused Lua arrays, emptied after each call
+		std::vector<LuaValue> effect_states;
+		std::vector<GameInst*> insts;
+	};
+	bool _active;
+	std::vector<Group> _groups;
+};
+
+#endif /* EFFECTSTEPBATCH_H_ */
@@ -0,0 +1,101 @@
+/*
+ * GameDrawList.cpp:
+ *  Depth ordered list of everything to draw for a region of a level.
+ *  Instances are culled to the region through the spatial grid of GameInstSet,
+ *  and are merged with the queued Lua drawables in a single sorted pass.
+ *  The buffers persist between frames, so rebuilding does not allocate.
+ *  A list built over the union of several split screens can be replayed for
+ *  each of them; drawing skips instances outside the current view.
+ */
+
+#include <algorithm>
+
+#include <lcommon/perf_timer.h>
+
+#include "objects/GameInst.h"
+
+#include "GameInstSet.h"
+#include "GameState.h"
+#include "LuaDrawableQueue.h"
+
+#include "GameDrawList.h"
+
+// Deepest first; instances before Lua drawables of the same depth
+bool GameDrawList::Entry::operator<(const Entry& o) const {
+	if (depth != o.depth) {
+		return depth > o.depth;
+	}
+	if (is_lua_drawable != o.is_lua_drawable) {
+		return !is_lua_drawable;
+	}
+	return order < o.order;
+}
+
+BBox GameDrawList::cull_region(const BBox& region) {
+	return BBox(region.x1 - CULL_MARGIN, region.y1 - CULL_MARGIN,
+			region.x2 + CULL_MARGIN, region.y2 + CULL_MARGIN);
+}
+
+bool GameDrawList::overlaps(const GameInst* inst, const BBox& cull) {
+	return inst->x + inst->radius >= cull.x1 && inst->x - inst->radius <= cull.x2
+			&& inst->y + inst->radius >= cull.y1
+			&& inst->y - inst->radius <= cull.y2;
+}
+
+void GameDrawList::build(GameInstSet& inst_set,
+		const LuaDrawableQueue& lua_drawables, const BBox& region) {
+	perf_timer_begin(FUNCNAME);
+	clear();
+	_lua_drawables = &lua_drawables;
+	_region = region;
+
+	inst_set.object_rectangle_test(cull_region(region), _instances);
+
+	for (int i = 0; i < _instances.size(); i++) {
+		GameInst* inst = _instances[i];
+		Entry entry = {inst->depth, false, inst->id, inst};
+		_entries.push_back(entry);
+	}
+	for (int i = 0; i < lua_drawables.size(); i++) {
+		Entry entry = {lua_drawables.entry_depth(i), true, i, NULL};
+		_entries.push_back(entry);
+	}
+	std::sort(_entries.begin(), _entries.end());
+
+	// Keep the instance list in draw order, for post_draw
+	_instances.clear();
+	for (int i = 0; i < _entries.size(); i++) {
+		if (!_entries[i].is_lua_drawable) {
+			_instances.push_back(_entries[i].inst);
+		}
+	}
+	perf_timer_end(FUNCNAME);
+}
+
+void GameDrawList::draw(GameState* gs) const {
+	BBox cull = cull_region(gs->view().region_covered());
+	for (int i = 0; i < _entries.size(); i++) {
+		const Entry& entry = _entries[i];
+		if (entry.is_lua_drawable) {
+			_lua_drawables->draw_entry(entry.order);
+		} else if (overlaps(entry.inst, cull)) {
+			entry.inst->draw(gs);
+		}
+	}
+}
+
+void GameDrawList::post_draw(GameState* gs) const {
+	BBox cull = cull_region(gs->view().region_covered());
+	for (int i = 0; i < _instances.size(); i++) {
+		if (overlaps(_instances[i], cull)) {
+			_instances[i]->post_draw(gs);
+		}
+	}
+}
+
+void GameDrawList::clear() {
+	_entries.clear();
+	_instances.clear();
+	_lua_drawables = NULL;
+	_region = BBox();
+}
@@ -0,0 +1,67 @@
+/*
+ * GameDrawList.h:
+ *  Depth ordered list of everything to draw for a region of a level.
+ *  Instances are culled to the region through the spatial grid of GameInstSet,
+ *  and are merged with the queued Lua drawables in a single sorted pass.
+ *  The buffers persist between frames, so rebuilding does not allocate.
+ *  A list built over the union of several split screens can be replayed for
+ *  each of them; drawing skips instances outside the current view.
+ */
+
+#ifndef GAMEDRAWLIST_H_
+#define GAMEDRAWLIST_H_
+
+#include <vector>
+
+#include <lcommon/geometry.h>
+
+class GameInst;
+class GameInstSet;
+class GameState;
+class LuaDrawableQueue;
+
+class GameDrawList {
+public:
+	enum {
+		// Objects may draw outside of their radius (eg health bars, names)
+		CULL_MARGIN = 192
+	};
+	GameDrawList() :
+			_lua_drawables(NULL) {
+	}
+
+	void build(GameInstSet& inst_set, const LuaDrawableQueue& lua_drawables,
+			const BBox& region);
+	// Region the list was last built over
+	const BBox& region() const {
+		return _region;
+	}
+	void draw(GameState* gs) const;
+	void post_draw(GameState* gs) const;
+	void clear();
+
+	// Culled instances, in draw order
+	const std::vector<GameInst*>& instances() const {
+		return _instances;
+	}
+	size_t size() const {
+		return _entries.size();
+	}
+private:
+	struct Entry {
+		int depth;
+		bool is_lua_drawable;
+		int order; // Instance id, or Lua drawable entry index
+		GameInst* inst;
+		bool operator<(const Entry& o) const;
+	};
+	static BBox cull_region(const BBox& region);
+	static bool overlaps(const GameInst* inst, const BBox& cull);
+
+	BBox _region;
+	std::vector<Entry> _entries;
+	std::vector<GameInst*> _instances;
+	const LuaDrawableQueue* _lua_drawables;
+};
+
+#endif /* GAMEDRAWLIST_H_ */
@@ -267,6 +267,8 @@ void GameInstSet::step(GameState* gs) {
 		GameInst::free_reference(deallocation_list[i]);
 	}
 	deallocation_list.clear();
+	_lua_step_batch.begin();
+	_effect_step_batch.begin();
 	for (int i = 0; i < unit_capacity; i++) {
 		GameInst* inst = unit_set[i].inst;
 		if (valid_inst(inst)) {
@@ -278,6 +280,10 @@ void GameInstSet::step(GameState* gs) {
 			perf_timer_end(typeid(*inst).name());
 		}
 	}
+	// One on_step_batch call per Lua type that defines it
+	_lua_step_batch.dispatch(gs->luastate());
+	// Then one step_batch_func call per batched effect type
+	_effect_step_batch.dispatch(gs->luastate());
 	perf_timer_end(FUNCNAME);
 }
 
@@ -421,6 +427,12 @@ int GameInstSet::object_radius_test(GameInst* obj, GameInst** objs, int obj_cap,
 }
 
 std::vector<GameInst*> GameInstSet::object_rectangle_test(BBox rect, GameInst* tester, col_filterf f) {
+	std::vector<GameInst*> instances;
+	object_rectangle_test(rect, instances, tester);
+	return instances;
+}
+
+void GameInstSet::object_rectangle_test(BBox rect, std::vector<GameInst*>& instances, GameInst* tester) {
 	int mingrid_x = rect.x1 / REGION_SIZE, mingrid_y = rect.y1 / REGION_SIZE;
 	int maxgrid_x = rect.x2 / REGION_SIZE, maxgrid_y = rect.y2 / REGION_SIZE;
 	int minx = squish(mingrid_x, 0, grid_w), miny = squish(mingrid_y, 0,
@@ -428,7 +440,6 @@ std::vector<GameInst*> GameInstSet::object_rectangle_test(BBox rect, GameInst* t
 	int maxx = squish(maxgrid_x, 0, grid_w), maxy = squish(maxgrid_y, 0,
 		grid_h);
 
-	std::vector<GameInst*> instances;
 	for (int yy = miny; yy <= maxy; yy++) {
 		int index = yy * grid_w + minx;
 		for (int xx = minx; xx <= maxx; xx++) {
@@ -448,7 +459,6 @@ std::vector<GameInst*> GameInstSet::object_rectangle_test(BBox rect, GameInst* t
 			}
 		}
 	}
-	return instances;
 }
 
 void GameInstSet::clear() {
@@ -461,6 +471,8 @@ void GameInstSet::clear() {
 	next_id = 1;
 	unit_amnt = 0;
 	depthlist_map.clear();
+	_lua_step_batch.clear();
+	_effect_step_batch.clear();
 	memset(&unit_set[0], 0, unit_capacity * sizeof(InstanceState));
 	memset(&unit_grid[0], 0, grid_w * grid_h * sizeof(InstanceLinkedList));
 }
@@ -15,6 +15,8 @@
 #include <vector>
 #include "objects/GameInst.h"
 #include "lanarts_defines.h"
+#include "LuaStepBatch.h"
+#include "EffectStepBatch.h"
 #include <map>
 
 class GameState;
@@ -34,6 +36,12 @@ public:
 	obj_id add_instance(GameInst* inst, int id = 0);
 	void remove_instance(GameInst* inst);
 	void step(GameState* state);
+	LuaStepBatch& lua_step_batch() {
+		return _lua_step_batch;
+	}
+	EffectStepBatch& effect_step_batch() {
+		return _effect_step_batch;
+	}
 
 	//Returns NULL if no unit found
 	GameInst* get_instance(int id) const;
@@ -59,6 +67,8 @@ public:
 	void copy_to(GameInstSet& inst_set) const;
 
 	std::vector<GameInst*> object_rectangle_test(BBox rect, GameInst* tester = NULL, col_filterf f = NULL);
+	//Appends to 'instances' rather than allocating a new vector, for callers that reuse a buffer
+	void object_rectangle_test(BBox rect, std::vector<GameInst*>& instances, GameInst* tester = NULL);
 	void clear();
 
 	void serialize(GameState* gs, SerializeBuffer& serializer);
@@ -106,6 +116,11 @@ private:
 	// unless additional references are retained to it
 	std::vector<GameInst*> deallocation_list;
 
+	// Instances of Lua types that are stepped with one on_step_batch call
+	LuaStepBatch _lua_step_batch;
+	// Effects that are stepped with one step_batch_func call per type
+	EffectStepBatch _effect_step_batch;
+
 	// Hashset portion
 	int next_id, unit_amnt, unit_capacity;
 	std::vector<InstanceState> unit_set;
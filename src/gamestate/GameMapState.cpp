@@ -101,16 +101,49 @@ obj_id GameMapState::add_instance(GameState* gs, GameInst* inst) {
 	return id;
 }
 
-void GameMapState::step(GameState* gs, bool simulate_monsters) {
-	const int STEPS_TO_SIMULATE = 1000;
+// Renumbers collision avoidance objects once enough have left the level
+static void compact_collision_avoidance(GameMapState* level) {
+	CollisionAvoidance& coll_avoid = level->collision_avoidance();
+	if (!coll_avoid.wants_compaction()) {
+		return;
+	}
+	std::vector<simul_id> remap;
+	coll_avoid.compact(remap);
+
+	std::vector<GameInst*> instances = level->game_inst_set().to_vector();
+	for (int i = 0; i < instances.size(); i++) {
+		CombatGameInst* inst = dynamic_cast<CombatGameInst*>(instances[i]);
+		if (inst == NULL) {
+			continue;
+		}
+		simul_id& id = inst->collision_simulation_id();
+		// Ids of removed objects are left as they were
+		if (id >= 0 && id < remap.size() && remap[id] >= 0) {
+			id = remap[id];
+		}
+	}
+}
+
+// Frames a level keeps being simulated for after its last player leaves
+static const int STEPS_TO_SIMULATE = 1000;
+// Levels without players step once per this many frames, staggered by level id
+static const int UNWATCHED_STEP_INTERVAL = 4;
 
+bool GameMapState::steps_on_frame(int frame, level_id id, bool has_player) {
+	return has_player || (frame + id) % UNWATCHED_STEP_INTERVAL == 0;
+}
+
+void GameMapState::step(GameState* gs, bool simulate_monsters) {
 	bool game_has_players = !gs->player_data().all_players().empty();
 	bool has_player_in_level = gs->player_data().level_has_player(id()) || !game_has_players;
 
 	if (has_player_in_level) {
 		_steps_left = STEPS_TO_SIMULATE;
 	}
-	if (_steps_left <= 0) {
+	// A level is not caught up on the frames it skipped when a player arrives,
+	// as that would step the arriving player (and its foes) more than once
+	if (!steps_on_frame(gs->frame(), id(), has_player_in_level)
+			|| _steps_left <= 0) {
 		return;
 	}
 	perf_timer_begin(FUNCNAME);
@@ -124,7 +157,8 @@ void GameMapState::step(GameState* gs, bool simulate_monsters) {
 	}
 	game_inst_set().step(gs);
 	tiles().step(gs);
-	_steps_left--;
+	compact_collision_avoidance(this);
+	_steps_left -= has_player_in_level ? 1 : UNWATCHED_STEP_INTERVAL;
 
 	gs->set_level(previous_level);
 
@@ -140,14 +174,9 @@ void GameMapState::draw(GameState* gs, bool reveal_all) {
 	GameMapState* previous_level = gs->get_level();
 	gs->set_level(this);
 
-	std::vector<GameInst*> safe_copy = game_inst_set().to_vector();
-	for (size_t i = 0; i < safe_copy.size(); i++) {
-		safe_copy[i]->draw(gs);
-	}
-
-	for (size_t i = 0; i < safe_copy.size(); i++) {
-		safe_copy[i]->post_draw(gs);
-	}
+	_draw_list.build(game_inst_set(), drawable_queue(), gs->view().region_covered());
+	_draw_list.draw(gs);
+	_draw_list.post_draw(gs);
 
 	monster_controller().post_draw(gs);
 	if (!reveal_all) {
@@ -16,6 +16,7 @@
 #include "pathfind/WanderMap.h"
 
 #include "LuaDrawableQueue.h"
+#include "GameDrawList.h"
 #include "GameInstSet.h"
 
 #include "GameTiles.h"
@@ -82,12 +83,19 @@ public:
 		return _drawable_queue;
 	}
 
+	/* Rebuilt for the current view every draw, kept to reuse its buffers */
+	GameDrawList& draw_list() {
+		return _draw_list;
+	}
+
 	obj_id add_instance(GameState* gs, GameInst* inst);
 
 	void serialize(GameState* gs, SerializeBuffer& serializer);
 	void deserialize(GameState* gs, SerializeBuffer& serializer);
 
 	void step(GameState* gs, bool simulate_monsters = true);
+	/* Levels without players step less often, staggered by their id */
+	static bool steps_on_frame(int frame, level_id id, bool has_player);
 	void draw(GameState* gs, bool reveal_all = false);
 
 	std::string& label() {
@@ -138,6 +146,7 @@ private:
 	CollisionAvoidance _collision_avoidance;
 	/* Used to store dynamic drawable information */
 	LuaDrawableQueue _drawable_queue;
+	GameDrawList _draw_list;
     int _vision_radius = 7;
 	bool _is_simulation;
 };
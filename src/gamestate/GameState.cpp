@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <vector>
 #include <functional>
+#include <algorithm>
 
 #include <lcommon/SerializeBuffer.h>
 #include <lcommon/directory.h>
@@ -484,6 +485,7 @@ bool GameState::step() {
 	}
 
         connection.poll_messages();
+        lsound::update();
 
     screens.for_each_screen( [&](){
         game_hud().step(this);
@@ -533,15 +535,50 @@ void GameState::adjust_view_to_dragging() {
 	is_dragging_view = is_dragged;
 }
 
-static void lua_drawables_draw_below_depth(LuaDrawableQueue::Iterator iter, int depth) {
-	for (; !iter.is_done() && iter.get_current_depth() < depth; iter.fetch_next()) {
-		iter.draw_current();
-	}
-}
-
-static void lua_drawables_draw_rest(LuaDrawableQueue::Iterator iter) {
-	for (; !iter.is_done(); iter.fetch_next()) {
-		iter.draw_current();
+struct SharedDrawRegion {
+	GameMapState* level;
+	BBox region, tile_region;
+	int screen_area, n_screens;
+};
+
+static BBox bbox_union(const BBox& a, const BBox& b) {
+	return BBox(std::min(a.x1, b.x1), std::min(a.y1, b.y1),
+			std::max(a.x2, b.x2), std::max(a.y2, b.y2));
+}
+
+// Split screens on the same level build its tile and instance draw lists
+// once, over the union of their views, and each screen replays them.
+// Screens far apart are cheaper to build separately, and are left alone.
+static void build_shared_draw_lists(GameState* gs,
+		std::vector<GameMapState*>& shared_levels) {
+	std::vector<SharedDrawRegion> regions;
+	gs->for_screens([&]() {
+		GameMapState* level = gs->get_level();
+		BBox region = gs->view().region_covered();
+		BBox tile_region = level->tiles().view_tile_region(gs);
+		for (int i = 0; i < regions.size(); i++) {
+			SharedDrawRegion& r = regions[i];
+			if (r.level == level) {
+				r.region = bbox_union(r.region, region);
+				r.tile_region = bbox_union(r.tile_region, tile_region);
+				r.screen_area += region.size().area();
+				r.n_screens++;
+				return;
+			}
+		}
+		SharedDrawRegion r = {level, region, tile_region, region.size().area(), 1};
+		regions.push_back(r);
+	});
+
+	for (int i = 0; i < regions.size(); i++) {
+		SharedDrawRegion& r = regions[i];
+		if (r.n_screens < 2 || r.region.size().area() > r.screen_area) {
+			continue;
+		}
+		r.level->tiles().build_draw_list(gs, r.tile_region);
+		r.level->draw_list().build(r.level->game_inst_set(),
+				r.level->drawable_queue(), r.region);
+		shared_levels.push_back(r.level);
 	}
 }
 
@@ -558,6 +595,14 @@ void GameState::draw(bool drawhud) {
         if (!get_level()){
             set_level(world.get_level(0));
         }
+    });
+
+    std::vector<GameMapState*> shared_levels;
+    build_shared_draw_lists(this, shared_levels);
+
+    screens.for_each_screen( [&]() {
+        bool shared = std::find(shared_levels.begin(), shared_levels.end(),
+                get_level()) != shared_levels.end();
 
         //if (drawhud) {
         ldraw::display_set_window_region(screens.window_region());
@@ -566,24 +611,22 @@ void GameState::draw(bool drawhud) {
         //            BBoxF(0, 0, view().width + game_hud().width(), view().height));
         //}
 
-        get_level()->tiles().pre_draw(this);
-
-        std::vector<GameInst *> safe_copy = get_level()->game_inst_set().to_vector();
-        LuaDrawableQueue::Iterator lua_drawables = get_level()->drawable_queue();
-
-        for (size_t i = 0; i < safe_copy.size(); i++) {
-            lua_drawables_draw_below_depth(lua_drawables, safe_copy[i]->depth);
-            safe_copy[i]->draw(this);
+        // Instances overlapping the view, merged with Lua drawables by depth
+        GameDrawList& draw_list = get_level()->draw_list();
+        if (shared) {
+            get_level()->tiles().draw_built(this);
+        } else {
+            get_level()->tiles().pre_draw(this);
+            draw_list.build(get_level()->game_inst_set(),
+                    get_level()->drawable_queue(), view().region_covered());
         }
-        lua_drawables_draw_rest(lua_drawables);
+        draw_list.draw(this);
 
         lua_api::luacall_post_draw(L);
 
         monster_controller().post_draw(this);
         get_level()->tiles().post_draw(this);
-        for (size_t i = 0; i < safe_copy.size(); i++) {
-            safe_copy[i]->post_draw(this);
-        }
+        draw_list.post_draw(this);
         // Set drawing region to full screen:
         ldraw::display_set_window_region({0,0,game_settings().view_width, game_settings().view_height});
         if (drawhud) {
@@ -25,7 +25,7 @@
 #include "GameTiles.h"
 
 GameTiles::GameTiles(const Size& size) :
-		_tiles(size) {
+		_solidity_version(0), _tiles(size) {
 
 	_solidity.set( new Grid<bool>(size, true) );
 	_seen.set( new Grid<bool>(size, false) );
@@ -60,7 +60,10 @@ void GameTiles::set_seethrough(const Pos& xy, bool seethrough) {
 }
 
 void GameTiles::set_solid(const Pos& xy, bool solid) {
-	(*_solidity)[xy] = solid;
+	if ((*_solidity)[xy] != solid) {
+		(*_solidity)[xy] = solid;
+		_solidity_version++;
+	}
 }
 
 bool GameTiles::is_solid(const Pos& xy) {
@@ -74,6 +77,7 @@ bool GameTiles::is_seethrough(const Pos& xy) {
 void GameTiles::clear() {
 	memset(_tiles.begin(), 0, sizeof(Tile) * size().area());
 	_solidity->fill(false);
+	_solidity_version++;
 	_seen->fill(false);
 	_seethrough->fill(false);
 }
@@ -84,18 +88,22 @@ void GameTiles::mark_all_seen() {
 
 void GameTiles::copy_to(GameTiles & t) const {
 	t._solidity = _solidity;
+	t._solidity_version++;
 	t._tiles = _tiles;
 }
 
 void GameTiles::pre_draw(GameState* gs, bool reveal_all) {
-	perf_timer_begin(FUNCNAME);
+	build_draw_list(gs, view_tile_region(gs), reveal_all);
+	draw_built(gs);
+}
 
+BBox GameTiles::view_tile_region(GameState* gs) {
 	Size size = this->size();
-    GameView view = gs->view();
-    view.width += gs->game_hud().sidebar_content_area().width();
+	GameView view = gs->view();
+	view.width += gs->game_hud().sidebar_content_area().width();
 	view.world_width = gs->get_level()->width();
 	view.world_height = gs->get_level()->height();
-    BBox region = view.tile_region_covered();
+	BBox region = view.tile_region_covered();
 
 	if (region.x2 >= size.w) {
 		region.x2 = size.w - 1;
@@ -103,21 +111,45 @@ void GameTiles::pre_draw(GameState* gs, bool reveal_all) {
 	if (region.y2 >= size.h) {
 		region.y2 = size.h - 1;
 	}
+	return region;
+}
+
+void GameTiles::build_draw_list(GameState* gs, const BBox& region,
+		bool reveal_all) {
+	perf_timer_begin(FUNCNAME);
+	_draw_list.clear();
 	// Reveal all if no players present:
 	reveal_all |= gs->player_data().all_players().empty();
 
-        GLImage::start_batch_draw();
 	for (int y = region.y1; y <= region.y2; y++) {
 		for (int x = region.x1; x <= region.x2; x++) {
-			Tile& tile = get(Pos(x, y));
-			const ldraw::Image& img = res::tile(tile.tile).img(tile.subtile);
 			if (reveal_all || was_seen(Pos(x, y))) {
-                            img.batch_draw(on_screen(gs, Pos(x * TILE_SIZE, y * TILE_SIZE)));
+				Tile& tile = get(Pos(x, y));
+				TileDraw entry = {&res::tile(tile.tile).img(tile.subtile),
+						Pos(x, y)};
+				_draw_list.push_back(entry);
 			}
 		}
 	}
-        GLImage::end_batch_draw();
+	perf_timer_end(FUNCNAME);
+}
 
+void GameTiles::draw_built(GameState* gs) {
+	perf_timer_begin(FUNCNAME);
+	// The list may cover other screens, only the transform differs
+	BBox region = view_tile_region(gs);
+
+	GLImage::start_batch_draw();
+	for (int i = 0; i < _draw_list.size(); i++) {
+		const TileDraw& entry = _draw_list[i];
+		const Pos& xy = entry.xy;
+		if (xy.x >= region.x1 && xy.x <= region.x2 && xy.y >= region.y1
+				&& xy.y <= region.y2) {
+			entry.img->batch_draw(on_screen(gs,
+					Pos(xy.x * TILE_SIZE, xy.y * TILE_SIZE)));
+		}
+	}
+	GLImage::end_batch_draw();
 	perf_timer_end(FUNCNAME);
 }
 
@@ -309,6 +341,7 @@ void GameTiles::deserialize(SerializeBuffer& serializer) {
 
 	serializer.read_container(_tiles._internal_vector());
 	serializer.read_container(_solidity->_internal_vector());
+	_solidity_version++;
 	serializer.read_container(_seen->_internal_vector());
 	serializer.read_container(_seethrough->_internal_vector());
 }
@@ -317,6 +350,10 @@ BoolGridRef GameTiles::solidity_map() const {
 	return _solidity;
 }
 
+int GameTiles::solidity_version() const {
+	return _solidity_version;
+}
+
 
 BoolGridRef GameTiles::previously_seen_map() const {
 	return _seen;
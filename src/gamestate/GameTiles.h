@@ -21,6 +21,10 @@
 class GameState;
 class SerializeBuffer;
 
+namespace ldraw {
+class Image;
+}
+
 struct Pos;
 
 /*Represents a single square tile*/
@@ -41,6 +45,14 @@ public:
 	void pre_draw(GameState* gs, bool reveal_all = false);
 	void post_draw(GameState* gs);
 
+	/* Split screens that look at the same level share one tile draw list:
+	 * it is built once over the union of their regions, and each screen
+	 * only replays the tiles that fall within its own view. */
+	BBox view_tile_region(GameState* gs);
+	void build_draw_list(GameState* gs, const BBox& region,
+			bool reveal_all = false);
+	void draw_built(GameState* gs);
+
 	int tile_width();
 	int tile_height();
 
@@ -67,6 +79,8 @@ public:
 	void deserialize(SerializeBuffer& serializer);
 
 	BoolGridRef solidity_map() const;
+	/* Changes whenever tile solidity is set, deserialized or cleared */
+	int solidity_version() const;
 	BoolGridRef previously_seen_map() const;
 	BoolGridRef seethrough_map() const;
 private:
@@ -74,10 +88,18 @@ private:
 	/* Store mutable tile properties in share-able bitmaps.
 	 * GameTiles is considered the 'owner' for serialization purposes. */
 	BoolGridRef _solidity, _seen, _seethrough;
+	int _solidity_version;
 
 	/* Stores information about tiles, such as if they have
 	 * been seen yet, and if they are see-through */
 	Grid<Tile> _tiles;
+
+	/* Seen tiles of the last built region, in tile coordinates */
+	struct TileDraw {
+		const ldraw::Image* img;
+		Pos xy;
+	};
+	std::vector<TileDraw> _draw_list;
 };
 
 #endif /* GAMETILES_H_ */
@@ -25,6 +25,7 @@ void LuaDrawableQueue::add(const LuaField& lua_drawable, int depth,
 	_LuaDrawableQueueEntry entry;
 	entry.lua_drawable_index = _drawable_array.objlen(); //Note: lua indices start at 1
 	entry.next_entry_index = -1;
+	entry.depth = depth;
 	entry.position = position;
 
 	_entry_pool.push_back(entry);
@@ -34,7 +35,11 @@ void LuaDrawableQueue::add(const LuaField& lua_drawable, int depth,
 }
 
 void LuaDrawableQueue::clear() {
-	luaarray_clear(_drawable_array);
+	if (!_drawable_array.empty()) {
+		luaarray_clear(_drawable_array);
+	}
+	_entry_pool.clear();
+	_depth_to_list.clear();
 }
 
 void LuaDrawableQueue::link_entry(int entry_index, int depth) {
@@ -59,19 +64,25 @@ void LuaDrawableQueue::init(lua_State* L) {
 	_cached_position.newtable();
 }
 
-void LuaDrawableQueue::Iterator::draw_current() const {
-	lua_State* L = _queue._drawable_array.luastate();
-	_queue._drawable_array.push();
-	lua_rawgeti(L, -1, _current_entry->lua_drawable_index);
+void LuaDrawableQueue::draw_entry(int entry_index) const {
+	const _LuaDrawableQueueEntry& entry = _entry_pool[entry_index];
+	lua_State* L = _drawable_array.luastate();
+	_drawable_array.push();
+	lua_rawgeti(L, -1, entry.lua_drawable_index);
+	lua_replace(L, -2); // Pop the array
 	if (lua_isfunction(L, -1)) {
+		lua_call(L, 0, 0);
+	} else {
 		lua_getfield(L, -1, "draw");
-		lua_pushvalue(L, -2);
+		lua_insert(L, -2); // Object is the 'self' argument
 		lua_call(L, 1, 0);
-	} else {
-		lua_call(L, 0, 0);
 	}
 }
 
+void LuaDrawableQueue::Iterator::draw_current() const {
+	_queue.draw_entry(_current_entry - &_queue._entry_pool[0]);
+}
+
 LuaDrawableQueue::Iterator::Iterator(const LuaDrawableQueue& queue) :
 				_queue(queue),
 				_depth_map_iter(queue._depth_to_list.begin()) {
@@ -24,6 +24,7 @@ class GameState;
 struct _LuaDrawableQueueEntry {
 	int lua_drawable_index; // Points to LuaDrawableQueue::_drawable_array
 	int next_entry_index; // Points to LuaDrawableQueue::_entry_pool, -1 if end-of-list
+	int depth;
 	PosF position;
 };
 
@@ -39,6 +40,15 @@ public:
 	void add(const LuaField& lua_drawable, int depth, const PosF& position);
 	void clear();
 
+	/* Entries in order of addition, for merging with other draw lists */
+	int size() const {
+		return _entry_pool.size();
+	}
+	int entry_depth(int entry_index) const {
+		return _entry_pool[entry_index].depth;
+	}
+	void draw_entry(int entry_index) const;
+
 	/* NOTE: Does not follow C++ iterator design! */
 	class Iterator {
 	public:
@@ -0,0 +1,93 @@
+/*
+ * LuaStepBatch.cpp:
+ *  Groups the instances of Lua object types that define on_step_batch, so
+ *  that each type gets one Lua call per frame with all of its instances.
+ *  It comes after every instance stepped, including their own on_step.
+ *  The array passed to Lua is reused between frames.
+ */
+
+#include <lcommon/perf_timer.h>
+#include <luawrap/luawrap.h>
+
+#include "objects/GameInst.h"
+
+#include "LuaStepBatch.h"
+
+void LuaStepBatch::begin() {
+	_active = true;
+	for (int i = 0; i < _groups.size(); i++) {
+		_groups[i].insts.clear();
+	}
+}
+
+bool LuaStepBatch::add(GameInst* inst) {
+	LuaValue& lua_vars = inst->lua_variables;
+	if (!_active || lua_vars.empty() || lua_vars.isnil()) {
+		return false;
+	}
+	LuaCallbackCache& cache = inst->lua_callbacks;
+	lua_callbacks_resolve(lua_vars, cache);
+	if (cache.slots->refs[CALLBACK_ON_STEP_BATCH] == LUA_NOREF) {
+		return false;
+	}
+	for (int i = 0; i < _groups.size(); i++) {
+		if (_groups[i].slots == cache.slots) {
+			_groups[i].insts.push_back(inst);
+			return true;
+		}
+	}
+	Group group;
+	group.slots = cache.slots;
+	group.objects = LuaValue::newtable(lua_vars.luastate());
+	group.last_size = 0;
+	group.insts.push_back(inst);
+	_groups.push_back(group);
+	return true;
+}
+
+void LuaStepBatch::dispatch(lua_State* L) {
+	perf_timer_begin(FUNCNAME);
+	_active = false;
+	for (int i = 0; i < _groups.size(); i++) {
+		Group& group = _groups[i];
+		std::vector<GameInst*>& insts = group.insts;
+		if (insts.empty()) {
+			continue;
+		}
+
+		group.objects.push();
+		int objects_idx = lua_gettop(L);
+		int n = 0;
+		for (int j = 0; j < insts.size(); j++) {
+			// Removed during the step, by another object
+			if (insts[j]->destroyed) {
+				continue;
+			}
+			luawrap::push(L, insts[j]);
+			lua_rawseti(L, objects_idx, ++n);
+		}
+		// Clear what is left over from a larger previous frame
+		for (int j = n + 1; j <= group.last_size; j++) {
+			lua_pushnil(L);
+			lua_rawseti(L, objects_idx, j);
+		}
+		group.last_size = n;
+
+		// The slots may have gone stale during the step
+		GameInst* first = insts[0];
+		lua_callbacks_resolve(first->lua_variables, first->lua_callbacks);
+		int ref = first->lua_callbacks.slots->refs[CALLBACK_ON_STEP_BATCH];
+		if (n > 0 && ref != LUA_NOREF) {
+			lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+			lua_pushvalue(L, objects_idx);
+			lua_call(L, 1, 0);
+		}
+		lua_settop(L, objects_idx - 1);
+	}
+	perf_timer_end(FUNCNAME);
+}
+
+void LuaStepBatch::clear() {
+	_active = false;
+	_groups.clear();
+}
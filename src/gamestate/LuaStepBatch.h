@@ -0,0 +1,44 @@
+/*
+ * LuaStepBatch.h:
+ *  Groups the instances of Lua object types that define on_step_batch, so
+ *  that each type gets one Lua call per frame with all of its instances.
+ *  It comes after every instance stepped, including their own on_step.
+ *  The array passed to Lua is reused between frames.
+ */
+
+#ifndef LUASTEPBATCH_H_
+#define LUASTEPBATCH_H_
+
+#include <vector>
+
+#include <luawrap/LuaValue.h>
+
+class GameInst;
+struct LuaCallbackSlots;
+
+class LuaStepBatch {
+public:
+	LuaStepBatch() :
+			_active(false) {
+	}
+
+	/* Between begin() and dispatch(), instances of batched types are
+	 * collected instead of stepped */
+	void begin();
+	/* Returns false if the type of 'inst' has no on_step_batch */
+	bool add(GameInst* inst);
+	/* Calls on_step_batch(objects) once per type */
+	void dispatch(lua_State* L);
+	void clear();
+private:
+	struct Group {
+		LuaCallbackSlots* slots; // Stable for the lifetime of the type
+		LuaValue objects; // Reused Lua array
+		int last_size; // Entries set in 'objects' on the last dispatch
+		std::vector<GameInst*> insts;
+	};
+	bool _active;
+	std::vector<Group> _groups;
+};
+
+#endif /* LUASTEPBATCH_H_ */
@@ -10,6 +10,7 @@
 #include <ldraw/Font.h>
 #include <ldraw/DrawOptions.h>
 #include <ldraw/display.h>
+#include <ldraw/GLImage.h>
 
 #include "draw/colour_constants.h"
 
@@ -112,10 +113,12 @@ void GameChat::draw_player_chat(GameState* gs) const {
 		start_msg = messages.size() - msgs_in_screen;
 	}
 
+	GLImage::start_batch_draw();
 	for (int i = start_msg; i < messages.size(); i++) {
 		messages[i].draw(font, fade_out, text_pos);
 		text_pos.y += line_sep;
 	}
+	GLImage::end_batch_draw();
 
 	if (draw_typed_message) {
 		int type_y = chat_pos.y + chat_size.h - padding - line_sep;
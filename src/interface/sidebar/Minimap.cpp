@@ -3,6 +3,8 @@
  *  Handles drawing & state of a minimap
  */
 
+#include <cstring>
+
 #include "draw/TileEntry.h"
 #include "draw/colour_constants.h"
 
@@ -14,23 +16,13 @@
 #include <lcommon/math_util.h>
 #include <lcommon/perf_timer.h>
 
-#include <SDL_opengl.h>
-#include "Minimap.h"
+#include <ldraw/draw.h>
 
-static void fill_buff2d(char* buff, int w, int h, int x, int y,
-		const Colour& col, int rw = 2, int rh = 2) {
-	for (int yy = y; yy < y + rh; yy++)
-		for (int xx = x; xx < x + rw; xx++) {
-			if (yy > 0 && yy < h && xx > 0 && xx < h) {
-				int loc = yy * w + xx;
-				buff[loc * 4] = col.b;
-				buff[loc * 4 + 1] = col.g;
-				buff[loc * 4 + 2] = col.r;
-				buff[loc * 4 + 3] = col.a;
-			}
-		}
-}
+#include "Minimap.h"
 
+enum {
+	TILE_SEEN = 1, TILE_SOLID = 2, TILE_LIT = 4, TILE_KNOWN = 8
+};
 
 inline static void set_colour(char* buff, Colour col) {
 	buff[0] = col.b;
@@ -39,88 +31,17 @@ inline static void set_colour(char* buff, Colour col) {
 	buff[3] = col.a;
 }
 
-inline static void set_colour(char* buff, int x, int y, int ptw, Colour col) {
-	int loc = y * ptw + x;
-	set_colour(buff + loc * 4, col);
-}
-
-static void draw_rect2d(char* buff, int w, int h, BBox bbox, const Colour& col) {
-	for (int yy = bbox.y1; yy < bbox.y2; yy++)
-		for (int xx = bbox.x1; xx < bbox.x2; xx++) {
-			if (xx == bbox.x1 || yy == bbox.y1 || xx == bbox.x2 - 1 || yy == bbox.y2 - 1) {
-				set_colour(buff, xx, yy, w, col);
-			}
-		}
-}
-
-static void world2minimapbuffer(GameState* gs, char* buff,
-		const BBox& shown, int w, int h, int ptw, int pth) {
-	GameTiles& tiles = gs->tiles();
-	GameView& view = gs->view();
-
-	bool minimap_reveal = gs->key_down_state(SDLK_z);
-
-	std::vector<PlayerInst*> players = gs->player_data().players_in_level(gs->get_level()->id());
-	for (int y = 0; y < shown.height(); y++) {
-		char* iter = buff + y * ptw * 4;
-		for (int x = 0; x < shown.width(); x++) {
-			Pos xy(x + shown.x1, y + shown.y1);
-			int tile = tiles.get(xy).tile;
-			int seen = tiles.was_seen(xy) || minimap_reveal;
-			if (seen) {
-				if (!tiles.is_solid(xy)) {/*floor*/
-					iter[0] = 50, iter[1] = 50, iter[2] = 50, iter[3] = 255;
-				} else { //if (tile == 1){/*wall*/
-					set_colour(iter, Colour(200,225,200));
-				}
-			}
-
-			// Check if visible by a player on this level
-			bool within_fovs = false;
-			for (int i = 0; i < players.size(); i++) {
-				fov& fov = *players[i]->field_of_view;
-				if (fov.within_fov(xy.x, xy.y)) {
-					within_fovs = true;
-					break;
-				}
-			}
-			if (!within_fovs) {
-				iter[0] /=2 , iter[1] /= 2, iter[2] /= 2;
-			}
-			iter += 4;
+static void tile_state_colour(char* iter, unsigned char state) {
+	set_colour(iter, Colour(0, 0, 0));
+	if (state & TILE_SEEN) {
+		if (!(state & TILE_SOLID)) {/*floor*/
+			iter[0] = 50, iter[1] = 50, iter[2] = 50, iter[3] = 255;
+		} else { /*wall*/
+			set_colour(iter, Colour(200,225,200));
 		}
 	}
-	std::vector<GameInst*> instances = gs->get_level()->game_inst_set().to_vector();
-
-	for (int i = 0; i < instances.size(); i++) {
-		GameInst* instance = instances[i];
-		bool is_enemy = dynamic_cast<EnemyInst*>(instance);
-		bool is_feature = dynamic_cast<FeatureInst*>(instance);
-		if (is_enemy || is_feature) {
-			int ex = instance->x / TILE_SIZE;
-			int ey = instance->y / TILE_SIZE;
-			if (!shown.contains(ex, ey)) {
-				continue;
-			}
-
-			bool seen = tiles.was_seen(Pos(ex, ey));
-			if (is_enemy) {
-				seen = seen && gs->object_visible_test(instance);
-			} else if (is_feature) {
-				bool was_seen =
-						dynamic_cast<FeatureInst*>(instance)->has_been_seen();
-				seen = seen && was_seen;
-			}
-			if (!seen && !minimap_reveal) {
-				continue;
-			}
-
-			if (is_enemy) {
-				set_colour(buff, ex - shown.x1, ey - shown.y1, ptw, Colour(255, 0, 0));
-			} else if (is_feature) {
-				set_colour(buff, ex - shown.x1, ey - shown.y1, ptw, Colour(0, 255, 0));
-			}
-		}
+	if (!(state & TILE_LIT)) {
+		iter[0] /=2 , iter[1] /= 2, iter[2] /= 2;
 	}
 }
 
@@ -128,7 +49,7 @@ static const int MINIMAP_DIM_MAX = 128;
 static const Size MINIMAP_SIZE_MAX(MINIMAP_DIM_MAX, MINIMAP_DIM_MAX);
 
 Minimap::Minimap(const Pos& minimap_center) :
-		minimap_center(minimap_center), minimap_arr(NULL) {
+		minimap_center(minimap_center) {
 	scale = 2;
 }
 
@@ -141,16 +62,6 @@ BBox Minimap::minimap_bounds(GameState* gs) const {
 	return BBox(draw_x, draw_y, draw_x + size.w, draw_y + size.h);
 }
 
-static void init_minimap_buff(char* minimap_arr, int ptw, int pth) {
-	int buffsize = ptw * pth;
-	for (int i = 0; i < buffsize; i++) {
-		minimap_arr[i * 4] = 0;
-		minimap_arr[i * 4 + 1] = 0;
-		minimap_arr[i * 4 + 2] = 0;
-		minimap_arr[i * 4 + 3] = 255;
-	}
-}
-
 static BBox find_portion(Pos center, Size desired_size, Size world_size) {
 	Pos try_xy = center - Pos(desired_size.w/2, desired_size.h/2);
 	try_xy = Pos(std::min(try_xy.x, world_size.w - desired_size.w), std::min(try_xy.y, world_size.h - desired_size.h));
@@ -159,35 +70,172 @@ static BBox find_portion(Pos center, Size desired_size, Size world_size) {
 	return BBox(try_bbox.left_top(), desired_size).resized_within(world_bbox);
 }
 
-// Draws a minimap from the contents of gs->tile_grid()
-void Minimap::draw(GameState* gs) {
-	perf_timer_begin(FUNCNAME);
+Minimap::LevelTexture& Minimap::level_texture(GameState* gs) {
+	Size size = gs->tiles().size();
+	// Free the textures of levels removed by a game reset
+	GameWorld& world = gs->game_world();
+	for (auto it = level_textures.begin(); it != level_textures.end();) {
+		bool removed = it->first >= world.number_of_levels()
+				|| world.get_level(it->first) != it->second.level;
+		it = removed ? level_textures.erase(it) : ++it;
+	}
+	GameMapState* level = gs->get_level();
+	LevelTexture& texture = level_textures[level->id()];
+	texture.level = level;
+	if (texture.size != size) {
+		// New level (or a level id that was reused); start from black
+		texture.size = size;
+		texture.texture_size = Size(power_of_two_round(size.w),
+				power_of_two_round(size.h));
+		texture.pixels.assign(texture.texture_size.area() * 4, 0);
+		for (int i = 0; i < texture.texture_size.area(); i++) {
+			texture.pixels[i * 4 + 3] = (char)255;
+		}
+		texture.tile_states.assign(size.area(), 0);
+		texture.image = ldraw::Image();
+		texture.image.from_bytes(texture.texture_size, &texture.pixels[0]);
+		// Prevent blurriness when scaling
+		texture.image.set_smooth(false);
+	}
+	return texture;
+}
+
+// Refreshes the tiles of 'region' from gs->tiles(), uploading only what changed
+void Minimap::update_level_texture(GameState* gs, LevelTexture& texture,
+		const BBox& region) {
+	GameTiles& tiles = gs->tiles();
+	bool minimap_reveal = gs->key_down_state(SDLK_z);
+	int w = region.width(), h = region.height();
 
-	int ptw = power_of_two_round(MINIMAP_DIM_MAX), pth = power_of_two_round(MINIMAP_DIM_MAX);
-	if (!minimap_arr) {
-		minimap_arr = new char[ptw * pth * 4];
+	// Mark tiles visible by a player on this level, looking only at FOV bounds
+	lit_mask.assign(w * h, 0);
+	std::vector<PlayerInst*> players = gs->player_data().players_in_level(gs->get_level()->id());
+	for (int i = 0; i < players.size(); i++) {
+		fov& fov = *players[i]->field_of_view;
+		BBox fovbox = fov.tiles_covered();
+		int x1 = std::max(fovbox.x1, region.x1), x2 = std::min(fovbox.x2, region.x2 - 1);
+		int y1 = std::max(fovbox.y1, region.y1), y2 = std::min(fovbox.y2, region.y2 - 1);
+		for (int y = y1; y <= y2; y++) {
+			for (int x = x1; x <= x2; x++) {
+				if (fov.within_fov(x, y)) {
+					lit_mask[(y - region.y1) * w + (x - region.x1)] = 1;
+				}
+			}
+		}
 	}
 
-	init_minimap_buff(minimap_arr, ptw, pth);
+	BBox dirty(region.x2, region.y2, region.x1, region.y1);
+	for (int y = region.y1; y < region.y2; y++) {
+		for (int x = region.x1; x < region.x2; x++) {
+			Pos xy(x, y);
+			unsigned char state = TILE_KNOWN;
+			if (tiles.was_seen(xy) || minimap_reveal) {
+				state |= TILE_SEEN;
+			}
+			if (tiles.is_solid(xy)) {
+				state |= TILE_SOLID;
+			}
+			if (lit_mask[(y - region.y1) * w + (x - region.x1)]) {
+				state |= TILE_LIT;
+			}
+			unsigned char& old_state = texture.tile_states[y * texture.size.w + x];
+			if (old_state != state) {
+				old_state = state;
+				tile_state_colour(&texture.pixels[(y * texture.texture_size.w + x) * 4], state);
+				dirty.x1 = std::min(dirty.x1, x), dirty.y1 = std::min(dirty.y1, y);
+				dirty.x2 = std::max(dirty.x2, x + 1), dirty.y2 = std::max(dirty.y2, y + 1);
+			}
+		}
+	}
 
-	// Portion of world displayed on minimap
-	BBox world_portion = drawn_tile_region(gs, gs->view());
-	world2minimapbuffer(gs, minimap_arr, world_portion, world_portion.width(), world_portion.height(), ptw, pth);
+	if (dirty.x1 >= dirty.x2 || dirty.y1 >= dirty.y2) {
+		return; // Nothing changed
+	}
+
+	// Pack the changed rectangle & upload it with a single sub-image update
+	int row_bytes = dirty.width() * 4;
+	upload_buffer.resize(row_bytes * dirty.height());
+	for (int y = dirty.y1; y < dirty.y2; y++) {
+		memcpy(&upload_buffer[(y - dirty.y1) * row_bytes],
+				&texture.pixels[(y * texture.texture_size.w + dirty.x1) * 4],
+				row_bytes);
+	}
+	texture.image.from_bytes(dirty, &upload_buffer[0]);
+}
+
+static void draw_marker(const BBox& level_region, const BBox& bbox, int scale,
+		int tile_x, int tile_y, const Colour& col) {
+	if (!level_region.contains(tile_x, tile_y)) {
+		return;
+	}
+	Pos xy(bbox.x1 + (tile_x - level_region.x1) * scale,
+			bbox.y1 + (tile_y - level_region.y1) * scale);
+	ldraw::draw_rectangle(col, BBox(xy, Size(scale, scale)));
+}
+
+// Draws enemies, features & players on top of the minimap texture
+void Minimap::draw_markers(GameState* gs, const BBox& level_region,
+		const BBox& bbox) {
+	GameTiles& tiles = gs->tiles();
+	bool minimap_reveal = gs->key_down_state(SDLK_z);
+
+	// Features, from the spatial grid over the shown region
+	BBox world_region(level_region.x1 * TILE_SIZE, level_region.y1 * TILE_SIZE,
+			level_region.x2 * TILE_SIZE, level_region.y2 * TILE_SIZE);
+	marker_buffer.clear();
+	gs->get_level()->game_inst_set().object_rectangle_test(world_region,
+			marker_buffer);
+	for (int i = 0; i < marker_buffer.size(); i++) {
+		FeatureInst* feature = dynamic_cast<FeatureInst*>(marker_buffer[i]);
+		if (!feature) {
+			continue;
+		}
+		int ex = feature->x / TILE_SIZE, ey = feature->y / TILE_SIZE;
+		bool seen = tiles.was_seen(Pos(ex, ey)) && feature->has_been_seen();
+		if (seen || minimap_reveal) {
+			draw_marker(level_region, bbox, scale, ex, ey, Colour(0, 255, 0));
+		}
+	}
+
+	// Enemies, from the level's monster list
+	const std::vector<obj_id>& mids = gs->monster_controller().monster_ids();
+	for (int i = 0; i < mids.size(); i++) {
+		GameInst* enemy = gs->get_instance(mids[i]);
+		if (!enemy) {
+			continue;
+		}
+		int ex = enemy->x / TILE_SIZE, ey = enemy->y / TILE_SIZE;
+		bool seen = tiles.was_seen(Pos(ex, ey)) && gs->object_visible_test(enemy);
+		if (seen || minimap_reveal) {
+			draw_marker(level_region, bbox, scale, ex, ey, Colour(255, 0, 0));
+		}
+	}
 
 	std::vector<PlayerInst*> players_in_level = gs->player_data().players_in_level(gs->get_level()->id());
 	for (int i = 0; i < players_in_level.size(); i++) {
 		PlayerInst* player = players_in_level[i];
-		int arr_x = (player->x / TILE_SIZE) - world_portion.x1, arr_y = (player->y / TILE_SIZE) - world_portion.y1;
-		fill_buff2d(minimap_arr, ptw, pth, arr_x, arr_y, player->is_focus_player(gs) ? COL_YELLOW : COL_BABY_BLUE, 1, 1);
+		draw_marker(level_region, bbox, scale, player->x / TILE_SIZE,
+				player->y / TILE_SIZE,
+				player->is_focus_player(gs) ? COL_YELLOW : COL_BABY_BLUE);
 	}
-	minimap_buff.from_bytes(Size(ptw, pth), minimap_arr);
+}
+
+// Draws a minimap from the contents of gs->tile_grid()
+void Minimap::draw(GameState* gs) {
+	perf_timer_begin(FUNCNAME);
+
+	// Portion of world displayed on minimap
+	BBox world_portion = drawn_tile_region(gs, gs->view());
+	LevelTexture& texture = level_texture(gs);
+	update_level_texture(gs, texture, world_portion);
 
 	BBox draw_region = image_draw_region(gs, gs->view());
+	BBox level_region = draw_region.translated(world_portion.x1, world_portion.y1);
 
-	// Prevent blurriness when scaling
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	BBox bbox = minimap_bounds(gs);
-	minimap_buff.draw(ldraw::DrawOptions(draw_region).scale(SizeF(scale,scale)), bbox.left_top());
+	texture.image.draw(ldraw::DrawOptions(level_region).scale(SizeF(scale,scale)), bbox.left_top());
+	draw_markers(gs, level_region, bbox);
+
 	if (bbox.contains(gs->mouse_pos())) {
 		if (gs->mouse_left_click()) {
 			scale *= 2;
@@ -6,10 +6,15 @@
 #ifndef MINIMAP_H_
 #define MINIMAP_H_
 
+#include <map>
+#include <vector>
+
 #include <ldraw/Image.h>
 #include "lanarts_defines.h"
 
 class GameState;
+class GameInst;
+class GameMapState;
 
 class Minimap {
 public:
@@ -22,10 +27,28 @@ public:
 	BBox image_draw_region(GameState* gs, const GameView& view) const;
 
 private:
-	char* minimap_arr;
+	/* Persistent minimap texture covering a whole level.
+	 * Only tiles whose state changed since the last frame are re-uploaded. */
+	struct LevelTexture {
+		GameMapState* level = NULL;
+		Size size; // Level size, in tiles
+		Size texture_size; // Power-of-two texture size
+		std::vector<char> pixels; // RGBA, texture_size.w wide
+		std::vector<unsigned char> tile_states; // Last uploaded state of each tile
+		ldraw::Image image;
+	};
+
+	LevelTexture& level_texture(GameState* gs);
+	void update_level_texture(GameState* gs, LevelTexture& texture,
+			const BBox& region);
+	void draw_markers(GameState* gs, const BBox& level_region, const BBox& bbox);
+
 	int scale;
-	ldraw::Image minimap_buff;
 	Pos minimap_center;
+	std::map<level_id, LevelTexture> level_textures;
+	// Reused scratch buffers
+	std::vector<char> lit_mask, upload_buffer;
+	std::vector<GameInst*> marker_buffer;
 };
 
 #endif /* MINIMAP_H_ */
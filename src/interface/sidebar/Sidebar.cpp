@@ -6,6 +6,7 @@
 #include <ldraw/draw.h>
 #include <ldraw/Font.h>
 #include <ldraw/DrawOptions.h>
+#include <ldraw/GLImage.h>
 
 #include "draw/colour_constants.h"
 #include "draw/draw_statbar.h"
@@ -163,8 +164,11 @@ void Sidebar::draw(GameState* gs) {
 	PlayerInst* p = gs->local_player();
 
 	minimap.draw(gs);
+	// Only text is drawn here, so submit it all in one batch
+	GLImage::start_batch_draw();
 	draw_player_base_stats(gs, p, sidebar_bounds.x1 + 10,
 			sidebar_bounds.y1 + 237, sidebar_bounds.width());
+	GLImage::end_batch_draw();
 	draw_player_statbars(gs, p, sidebar_bounds.x1 + STATBAR_OFFSET_X,
 			sidebar_bounds.y1 + STATBAR_OFFSET_Y);
 	navigator.draw(gs);
@@ -9,5 +9,6 @@
 void lanarts_system_quit() {
 	lanarts_net_quit();
 	lsound::stop_music();
+	lsound::deinit();
 	SDL_Quit();
 }
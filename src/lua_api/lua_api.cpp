@@ -147,6 +147,7 @@ namespace lua_api {
 	void register_lua_core_Mouse(lua_State* L);
 	void register_lua_core_MiscSpellAndItemEffects(lua_State* L);
 	void register_lua_core_Serialization(lua_State* L);
+	void register_lua_core_ChunkCache(lua_State* L);
 
 	static int lua_lanarts_panic(lua_State* L) {
 		luawrap::errorfunc(L);
@@ -199,6 +200,7 @@ namespace lua_api {
 		register_lua_core_MiscSpellAndItemEffects(L);
 		register_lua_core_Mouse(L);
 		register_lua_core_EngineInternal(L);
+		register_lua_core_ChunkCache(L);
 		register_general_api(L);
 	}
 
@@ -103,17 +103,22 @@ class EffectiveAttackStats;
 void lua_gameinst_callback(lua_State* L, LuaValue& value, GameInst* inst);
 
 void lua_push_effectivestats(lua_State* L, GameInst* inst);
-void lua_push_effectivestats(lua_State* L, const EffectiveStats& stats);
+// Views 'stats' in place until released, after which the view reads as nil
+void lua_push_effectivestats(lua_State* L, EffectiveStats& stats);
+void lua_release_effectivestats(lua_State* L, int idx);
 void lua_push_effectiveattackstats(lua_State* L, const EffectiveAttackStats& stats);
 EffectiveAttackStats lua_pop_effectiveattackstats(lua_State *L);
-EffectiveStats& lua_get_effectivestats(lua_State* L, int idx);
 
 void lua_spelltarget_bindings(lua_State* L);
 void lua_effectivestats_bindings(GameState* gs, lua_State* L);
 void lua_combatstats_bindings(GameState* gs, lua_State* L);
 
 void lua_push_combatstats(lua_State* L, GameInst* inst);
+// Views 'stats' in place until released, after which the view reads as nil
+void lua_push_combatstats(lua_State* L, CombatStats& stats);
+// As above, but writes through the view are ignored
 void lua_push_combatstats(lua_State* L, const CombatStats& stats);
+void lua_release_combatstats(lua_State* L, int idx);
 
 void luayaml_push_item(lua_State* L, const char* name);
 
@@ -0,0 +1,303 @@
+/*
+ * lua_core_ChunkCache.cpp:
+ *  Caches compiled Lua and MoonScript modules as Lua bytecode.
+ *  Modules are looked up through package.loaders like the stock and MoonScript
+ *  loaders, but a module whose source hash (and VM) matches a cache entry is
+ *  loaded from lua_dump output, skipping the MoonScript compiler and the Lua parser.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <lua.hpp>
+
+#include <luawrap/luawrap.h>
+
+#include <lcommon/directory.h>
+#include <lcommon/strformat.h>
+
+#include "lua_api.h"
+
+#ifdef USE_LUAJIT
+#define CHUNK_CACHE_VM LUAJIT_VERSION
+#else
+#define CHUNK_CACHE_VM LUA_RELEASE
+#endif
+
+static const char CHUNK_CACHE_MAGIC[4] = {'L', 'C', 'C', '1'};
+static const char* DEFAULT_CACHE_DIRECTORY = "saves/chunk-cache";
+
+static std::string cache_directory = DEFAULT_CACHE_DIRECTORY;
+static int cache_hits = 0, cache_misses = 0;
+
+// FNV-1a, 64 bit
+static unsigned long long hash_bytes(const char* data, size_t len,
+		unsigned long long hash = 14695981039346656037ULL) {
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash ^ (unsigned char)data[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+static bool read_file(const std::string& path, std::string& contents) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL) {
+		return false;
+	}
+	contents.clear();
+	char buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		contents.append(buffer, read);
+	}
+	fclose(file);
+	return true;
+}
+
+static void write_file_atomic(const std::string& path, const std::string& contents) {
+	std::string tmp_path = path + ".tmp";
+	FILE* file = fopen(tmp_path.c_str(), "wb");
+	if (file == NULL) {
+		return;
+	}
+	bool ok = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+	ok = (fclose(file) == 0) && ok;
+	// Never leave a partially written entry under the real name
+	if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+		remove(tmp_path.c_str());
+	}
+}
+
+// Finds the first file matching 'name' in a package.path-style template list
+static bool search_path(const char* name, const char* templates, std::string& found) {
+	std::string name_path = name;
+	for (size_t i = 0; i < name_path.size(); i++) {
+		if (name_path[i] == '.') {
+			name_path[i] = '/';
+		}
+	}
+	const char* start = templates;
+	while (*start) {
+		const char* end = strchr(start, ';');
+		if (end == NULL) {
+			end = start + strlen(start);
+		}
+		std::string path;
+		for (const char* c = start; c != end; c++) {
+			if (*c == '?') {
+				path += name_path;
+			} else {
+				path += *c;
+			}
+		}
+		FILE* file = path.empty() ? NULL : fopen(path.c_str(), "rb");
+		if (file != NULL) {
+			fclose(file);
+			found = path;
+			return true;
+		}
+		start = (*end == ';') ? end + 1 : end;
+	}
+	return false;
+}
+
+// Creates the cache directory and its parents
+static bool ensure_cache_directory() {
+	for (size_t i = 1; i < cache_directory.size(); i++) {
+		if (cache_directory[i] == '/') {
+			ensure_directory(cache_directory.substr(0, i).c_str());
+		}
+	}
+	return ensure_directory(cache_directory.c_str());
+}
+
+static int dump_writer(lua_State* L, const void* p, size_t sz, void* ud) {
+	((std::string*)ud)->append((const char*)p, sz);
+	return 0;
+}
+
+static void write_int(std::string& str, int value) {
+	str.append((const char*)&value, sizeof(int));
+}
+
+static int read_int(const std::string& str, size_t& pos) {
+	int value;
+	memcpy(&value, str.data() + pos, sizeof(int));
+	pos += sizeof(int);
+	return value;
+}
+
+/* Cache entry layout:
+ *   [magic, <number of line table entries>, (<lua line>, <moon position>)*, <bytecode>]
+ * The line table lets MoonScript error rewriting work for cached modules. */
+static bool load_cache_entry(lua_State* L, const std::string& entry,
+		const std::string& chunkname, int line_tables_idx) {
+	size_t pos = sizeof(CHUNK_CACHE_MAGIC);
+	if (entry.size() < pos + sizeof(int)
+			|| memcmp(entry.data(), CHUNK_CACHE_MAGIC, pos) != 0) {
+		return false;
+	}
+	int n_lines = read_int(entry, pos);
+	if (n_lines < 0 || entry.size() < pos + n_lines * 2 * sizeof(int)) {
+		return false;
+	}
+	size_t line_table_pos = pos;
+	pos += n_lines * 2 * sizeof(int);
+	if (luaL_loadbuffer(L, entry.data() + pos, entry.size() - pos, chunkname.c_str()) != 0) {
+		lua_pop(L, 1); // Stale or foreign bytecode, recompile
+		return false;
+	}
+	if (n_lines > 0 && !lua_isnil(L, line_tables_idx)) {
+		lua_newtable(L);
+		for (int i = 0; i < n_lines; i++) {
+			int line = read_int(entry, line_table_pos);
+			lua_pushinteger(L, read_int(entry, line_table_pos));
+			lua_rawseti(L, -2, line);
+		}
+		lua_setfield(L, line_tables_idx, chunkname.c_str());
+	}
+	return true;
+}
+
+// Compiles 'source' and pushes the chunk, raising a Lua error on failure
+static void compile_chunk(lua_State* L, const std::string& source, const std::string& path,
+		const std::string& chunkname, bool is_moon, int to_lua_idx, int line_tables_idx,
+		std::string& entry) {
+	entry.assign(CHUNK_CACHE_MAGIC, sizeof(CHUNK_CACHE_MAGIC));
+	int n_lines = 0;
+	write_int(entry, n_lines);
+
+	if (is_moon) {
+		lua_pushvalue(L, to_lua_idx);
+		lua_pushlstring(L, source.data(), source.size());
+		lua_call(L, 1, 2);
+		if (lua_isnil(L, -2)) {
+			luaL_error(L, "%s: %s", path.c_str(), lua_tostring(L, -1));
+		}
+		// Stack: [code, line table]
+		if (lua_istable(L, -1)) {
+			lua_pushnil(L);
+			while (lua_next(L, -2) != 0) {
+				write_int(entry, lua_tointeger(L, -2));
+				write_int(entry, lua_tointeger(L, -1));
+				n_lines++;
+				lua_pop(L, 1);
+			}
+			memcpy(&entry[sizeof(CHUNK_CACHE_MAGIC)], &n_lines, sizeof(int));
+			if (!lua_isnil(L, line_tables_idx)) {
+				lua_pushvalue(L, -1);
+				lua_setfield(L, line_tables_idx, chunkname.c_str());
+			}
+		}
+		size_t len;
+		const char* code = lua_tolstring(L, -2, &len);
+		if (luaL_loadbuffer(L, code, len, chunkname.c_str()) != 0) {
+			luaL_error(L, "%s: %s", path.c_str(), lua_tostring(L, -1));
+		}
+		lua_replace(L, -3);
+		lua_pop(L, 1);
+	} else if (luaL_loadbuffer(L, source.data(), source.size(), chunkname.c_str()) != 0) {
+		luaL_error(L, "error loading module from file '%s':\n\t%s",
+				path.c_str(), lua_tostring(L, -1));
+	}
+	lua_dump(L, dump_writer, &entry);
+}
+
+// package.loaders entry. Upvalues: [moonscript to_lua, moonscript line_tables]
+static int chunk_cache_loader(lua_State* L) {
+	const char* name = luaL_checkstring(L, 1);
+	int to_lua_idx = lua_upvalueindex(1), line_tables_idx = lua_upvalueindex(2);
+
+	// Same precedence as the MoonScript loader, which sits before the Lua loader
+	std::string path;
+	bool is_moon = false;
+	lua_getglobal(L, "package");
+	lua_getfield(L, -1, "moonpath");
+	if (!lua_isnil(L, to_lua_idx) && lua_isstring(L, -1)) {
+		is_moon = search_path(name, lua_tostring(L, -1), path);
+	}
+	lua_getfield(L, -2, "path");
+	bool found = is_moon || (lua_isstring(L, -1) && search_path(name, lua_tostring(L, -1), path));
+	lua_pop(L, 3);
+	if (!found) {
+		lua_pushfstring(L, "\n\tno cached chunk for '%s'", name);
+		return 1;
+	}
+
+	std::string source;
+	if (!read_file(path, source)) {
+		lua_pushfstring(L, "\n\tcould not read '%s'", path.c_str());
+		return 1;
+	}
+	std::string chunkname = "@" + path;
+	unsigned long long hash = hash_bytes(CHUNK_CACHE_VM, strlen(CHUNK_CACHE_VM));
+	hash = hash_bytes(chunkname.data(), chunkname.size(), hash);
+	hash = hash_bytes(source.data(), source.size(), hash);
+	std::string entry_path = format("%s/%016llx.luac", cache_directory.c_str(), hash);
+
+	std::string entry;
+	if (read_file(entry_path, entry) && load_cache_entry(L, entry, chunkname, line_tables_idx)) {
+		cache_hits++;
+		return 1;
+	}
+	cache_misses++;
+	compile_chunk(L, source, path, chunkname, is_moon, to_lua_idx, line_tables_idx, entry);
+	if (ensure_cache_directory()) {
+		write_file_atomic(entry_path, entry);
+	}
+	return 1;
+}
+
+// Inserts the cache loader before the MoonScript and Lua file loaders, optionally
+// taking the cache directory. Does nothing if LANARTS_NO_CHUNK_CACHE is set.
+static int chunk_cache_insert_loader(lua_State* L) {
+	if (getenv("LANARTS_NO_CHUNK_CACHE") != NULL) {
+		lua_pushboolean(L, 0);
+		return 1;
+	}
+	if (!lua_isnoneornil(L, 1)) {
+		cache_directory = luaL_checkstring(L, 1);
+	} else if (getenv("LANARTS_CHUNK_CACHE") != NULL) {
+		cache_directory = getenv("LANARTS_CHUNK_CACHE");
+	}
+
+	LuaValue moonscript = lua_api::import(L, "moonscript.base");
+	moonscript["to_lua"].push();
+	lua_api::import(L, "moonscript.line_tables").push();
+	lua_pushcclosure(L, chunk_cache_loader, 2);
+
+	// table.insert(package.loaders, 2, loader)
+	lua_getglobal(L, "package");
+	lua_getfield(L, -1, "loaders");
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		lua_getfield(L, -1, "searchers");
+	}
+	int loaders = lua_gettop(L);
+	for (int i = lua_objlen(L, loaders); i >= 2; i--) {
+		lua_rawgeti(L, loaders, i);
+		lua_rawseti(L, loaders, i + 1);
+	}
+	lua_pushvalue(L, loaders - 2);
+	lua_rawseti(L, loaders, 2);
+	lua_pop(L, 3);
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
+static int chunk_cache_stats(lua_State* L) {
+	lua_pushinteger(L, cache_hits);
+	lua_pushinteger(L, cache_misses);
+	return 2;
+}
+
+namespace lua_api {
+	void register_lua_core_ChunkCache(lua_State* L) {
+		LuaValue module = register_lua_submodule(L, "core.ChunkCache");
+		module["insert_loader"].bind_function(chunk_cache_insert_loader);
+		module["stats"].bind_function(chunk_cache_stats);
+	}
+}
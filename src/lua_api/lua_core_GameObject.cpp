@@ -21,6 +21,7 @@
 #include "data/game_data.h"
 
 #include "objects/GameInst.h"
+#include "objects/LuaCallbackSlots.h"
 #include "objects/AnimatedInst.h"
 #include "objects/EnemyInst.h"
 #include "objects/FeatureInst.h"
@@ -82,12 +83,31 @@ static int lapi_gameinst_getter_fallback(lua_State* L) {
 
 /* Use a per-instance lua table as a fallback */
 static int lapi_gameinst_setter_fallback(lua_State* L) {
+	int callback = lua_type(L, 2) == LUA_TSTRING ?
+			lua_callback_by_name(lua_tostring(L, 2)) : -1;
+	if (callback != -1) {
+		// The hook now overrides its type's, for this object only
+		lua_pushliteral(L, "__objectref");
+		lua_rawget(L, 1);
+		GameInst** inst = (GameInst**)lua_touserdata(L, -1);
+		if (inst && *inst) {
+			lua_callbacks_instance_changed((*inst)->lua_callbacks,
+					(lua_callback_t)callback);
+		}
+		lua_pop(L, 1);
+	}
 	lua_pushvalue(L, 2);
 	lua_pushvalue(L, 3);
 	lua_rawset(L, 1);
 	return 1;
 }
 
+static int lapi_invalidate_callbacks(lua_State* L) {
+	luaL_checktype(L, 1, LUA_TTABLE);
+	lua_callbacks_invalidate(L, 1);
+	return 0;
+}
+
 static int lapi_gameinst_freeref(lua_State* L) {
 	GameInst::free_reference(luawrap::get<GameInst*>(L, 1));
 	return 0;
@@ -125,17 +145,17 @@ static LuaValue lua_gameinst_base_metatable(lua_State* L) {
 	LUAWRAP_GETTER(getters, xy, OBJ->pos());
 	LUAWRAP_GETTER(getters, xy_previous, Pos(OBJ->last_x, OBJ->last_y));
 	LUAWRAP_GETTER(getters, tile_xy, Pos(OBJ->x / TILE_SIZE, OBJ->y / TILE_SIZE));
-	luawrap::bind_getter(getters["x"], &GameInst::x);
-	luawrap::bind_getter(getters["y"], &GameInst::y);
+	LUAWRAP_FAST_GETTER(getters["x"], GameInst, x);
+	LUAWRAP_FAST_GETTER(getters["y"], GameInst, y);
 	luawrap::bind_getter(getters["__table"], &GameInst::lua_variables);
-	luawrap::bind_getter(getters["x_previous"], &GameInst::last_x);
-	luawrap::bind_getter(getters["y_previous"], &GameInst::last_y);
-	luawrap::bind_getter(getters["destroyed"], &GameInst::destroyed);
-	luawrap::bind_getter(getters["id"], &GameInst::id);
-	luawrap::bind_getter(getters["depth"], &GameInst::depth);
-	luawrap::bind_getter(getters["radius"], &GameInst::radius);
-    luawrap::bind_getter(getters["solid"], &GameInst::solid);
-	luawrap::bind_getter(getters["target_radius"], &GameInst::target_radius);
+	LUAWRAP_FAST_GETTER(getters["x_previous"], GameInst, last_x);
+	LUAWRAP_FAST_GETTER(getters["y_previous"], GameInst, last_y);
+	LUAWRAP_FAST_GETTER(getters["destroyed"], GameInst, destroyed);
+	LUAWRAP_FAST_GETTER(getters["id"], GameInst, id);
+	LUAWRAP_FAST_GETTER(getters["depth"], GameInst, depth);
+	LUAWRAP_FAST_GETTER(getters["radius"], GameInst, radius);
+    LUAWRAP_FAST_GETTER(getters["solid"], GameInst, solid);
+	LUAWRAP_FAST_GETTER(getters["target_radius"], GameInst, target_radius);
 	getters["map"].bind_function(lapi_gameinst_map);
 	LUAWRAP_GETTER(meta, __tostring, typeid(*OBJ).name());
 
@@ -206,13 +226,13 @@ static LuaValue lua_combatgameinst_metatable(lua_State* L) {
 
     LuaValue getters = luameta_getters(meta);
     LuaValue setters = luameta_setters(meta);
-	luawrap::bind_getter(getters["vx"], &CombatGameInst::vx);
-        luawrap::bind_getter(getters["vy"], &CombatGameInst::vy);
-	luawrap::bind_getter(getters["is_resting"], &CombatGameInst::is_resting);
+	LUAWRAP_FAST_GETTER(getters["vx"], CombatGameInst, vx);
+        LUAWRAP_FAST_GETTER(getters["vy"], CombatGameInst, vy);
+	LUAWRAP_FAST_GETTER(getters["is_resting"], CombatGameInst, is_resting);
     LUAWRAP_GETTER(getters, sprite, game_sprite_data.get(OBJ->get_sprite()).sprite);
-    luawrap::bind_getter(getters["team"], &CombatGameInst::team);
-    luawrap::bind_getter(getters["vision_radius"], &CombatGameInst::vision_radius);
-    luawrap::bind_setter(setters["vision_radius"], &CombatGameInst::vision_radius);
+    LUAWRAP_FAST_GETTER(getters["team"], CombatGameInst, team);
+    LUAWRAP_FAST_GETTER(getters["vision_radius"], CombatGameInst, vision_radius);
+    LUAWRAP_FAST_SETTER(setters["vision_radius"], CombatGameInst, vision_radius);
 	getters["stats"].bind_function(lapi_gameinst_stats);
 
 	LuaValue methods = luameta_constants(meta);
@@ -784,6 +804,15 @@ static const char* get_type(GameInst* inst) {
     return "<Unknown>";
 }
 namespace lua_api {
+	// Returns hits, misses & per-frame-dynamic recomputations over all effective stat caches
+	static int effective_stats_cache_counts(lua_State* L) {
+		EffectiveStatsCacheCounts counts = ::effective_stats_cache_counts();
+		lua_pushnumber(L, counts.hits);
+		lua_pushnumber(L, counts.misses);
+		lua_pushnumber(L, counts.dynamic);
+		return 3;
+	}
+
 	// Ensures important objects are reached during serialization:
 	static void ensure_reachability(LuaValue globals, LuaValue submodule) {
 		lua_State* L = submodule.luastate();
@@ -801,6 +830,8 @@ namespace lua_api {
 		submodule["Base"].pop();
 		luameta_push(L, &GameInstWrap::ref_metatable);
 		submodule["REF_META"].pop();
+		lua_callbacks_push_watcher(L);
+		submodule["CALLBACK_WATCHER"].pop();
 	}
 	void register_lua_core_GameObject(lua_State* L) {
 		luawrap::install_type<GameInst*, GameInstWrap::push, GameInstWrap::get, GameInstWrap::check>();
@@ -845,8 +876,12 @@ namespace lua_api {
 		submodule["store_create"].bind_function(store_create);
                 submodule["player_create"].bind_function(player_create);
                 submodule["get_type"].bind_function(get_type);
+		// For when a hook an object type already defines is replaced after
+		// objects used it. New hooks are picked up without it.
+		submodule["invalidate_callbacks"].bind_function(lapi_invalidate_callbacks);
 		submodule["destroy"].bind_function(object_destroy);
 		submodule["add_to_level"].bind_function(object_add);
+		submodule["effective_stats_cache_counts"].bind_function(effective_stats_cache_counts);
 
 		submodule["DOOR_OPEN"] = (int)FeatureInst::DOOR_OPEN;
 		submodule["DOOR_CLOSED"] = (int)FeatureInst::DOOR_CLOSED;
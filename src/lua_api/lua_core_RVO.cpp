@@ -41,6 +41,21 @@ static void change_instance_id(RVOSimulator& sim,
     sim.changeAgentNo(id, new_id);
 }
 
+// Renumbers the instances densely, returning a table of old id -> new id
+static int compact(lua_State* L) {
+    RVOSimulator* sim = luawrap::get<RVOSimulator*>(L, 1);
+    std::vector<size_t> remap;
+    sim->compactAgents(remap);
+    lua_newtable(L);
+    for (size_t id = 0; id < remap.size(); id++) {
+        if (remap[id] != RVO_ERROR) {
+            lua_pushinteger(L, remap[id]);
+            lua_rawseti(L, -2, id);
+        }
+    }
+    return 1;
+}
+
 static int get_velocity(lua_State* L) {
     RVOSimulator* sim = luawrap::get<RVOSimulator*>(L, 1);
     Vector2 velocity = sim->getAgentVelocity(lua_tointeger(L, 2));
@@ -108,6 +123,7 @@ LuaValue lua_rvoworldmetatable(lua_State* L) {
     methods["get_preferred_velocity"].bind_function(get_preferred_velocity);
     methods["set_preferred_velocity"].bind_function(set_preferred_velocity);
     methods["change_instance_id"].bind_function(change_instance_id);
+    methods["compact"].bind_function(compact);
     methods["step"].bind_function(step);
     methods["clear"].bind_function(clear);
 
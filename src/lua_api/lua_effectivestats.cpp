@@ -16,156 +16,73 @@
 #include "stats/stats.h"
 
 #include "lua_api.h"
-#include "lunar.h"
+#include "lua_statsview.h"
 
-class EffectiveStatsLuaBinding {
-public:
-	static const char className[];
-	static Lunar<EffectiveStatsLuaBinding>::RegType methods[];
+typedef LuaStatsView<EffectiveStats> view_t;
 
-	EffectiveStatsLuaBinding(GameInst* inst) :
-			inst(inst) {
-	}
-	EffectiveStatsLuaBinding(const EffectiveStats& value) :
-			value(value) {
-	}
+#define STATS_NUM_FIELD(n, m) {n, \
+	[](lua_State* L, EffectiveStats& stats) { lua_pushnumber(L, stats.m); }, \
+	[](lua_State* L, EffectiveStats& stats, int idx) { stats.m = lua_tonumber(L, idx); }}
+#define STATS_NUM_LOOKUP_FIELD(n, m) {n, \
+	[](lua_State* L, EffectiveStats& stats) { lua_pushnumber(L, stats.m); }, NULL}
 
-	EffectiveStats* get_stats(lua_State* L) {
-		if (!inst.get())
-			return &value;
-		GameState* gs = lua_api::gamestate(L);
-		CombatGameInst* combat_inst =
-				dynamic_cast<CombatGameInst*>(inst.get());
-		if (!combat_inst)
-			return NULL;
-		return &combat_inst->effective_stats();
+static void push_spells(lua_State* L, EffectiveStats& stats) {
+	auto table = LuaValue::newtable(L);
+	for (spell_id id : stats.spells.spell_id_list()) {
+		table[table.objlen() + 1] = game_spell_data.get(id);
 	}
-
-private:
-	GameInstRef inst; //If inst != NULL, use object stats
-	EffectiveStats value; //If id == 0, use this
-};
-
-typedef EffectiveStatsLuaBinding bind_t;
-typedef Lunar<EffectiveStatsLuaBinding> lunar_t;
-typedef lunar_t::RegType meth_t;
-#define LUA_DEF(m) meth_t(#m, &bind_t:: m)
-
-static int lua_member_lookup(lua_State* L) {
-#define IFLUA_NUM_MEMB_LOOKUP(n, m) \
-		if (strncmp(cstr, n, sizeof(n))==0){\
-		lua_pushnumber(L, m );\
-	}
-
-	bind_t* state = lunar_t::check(L, 1);
-	const char* cstr = lua_tostring(L, 2);
-	EffectiveStats* stats = state->get_stats(L);
-
-	if (!stats) {
-		lua_pushnil(L);
-		return 1;
-	}
-        if (strncmp(cstr, "spells", sizeof("spells")) == 0) {
-            auto table = LuaValue::newtable(L);
-            for (spell_id id : stats->spells.spell_id_list()) {
-				table[table.objlen() + 1] = game_spell_data.get(id);
-			}
-			table.push();
-            return 1;
-        }
-
-	IFLUA_NUM_MEMB_LOOKUP("hp", stats->core.hp)
-	else IFLUA_NUM_MEMB_LOOKUP("mp", stats->core.mp)
-	else IFLUA_NUM_MEMB_LOOKUP("max_hp", stats->core.max_hp)
-    else IFLUA_NUM_MEMB_LOOKUP("max_mp", stats->core.max_mp)
-    else IFLUA_NUM_MEMB_LOOKUP("hpregen", stats->core.hpregen)
-    else IFLUA_NUM_MEMB_LOOKUP("mpregen", stats->core.mpregen)
-	else IFLUA_NUM_MEMB_LOOKUP("strength", stats->core.strength)
-	else IFLUA_NUM_MEMB_LOOKUP("spell_velocity_multiplier", stats->core.spell_velocity_multiplier)
-	else IFLUA_NUM_MEMB_LOOKUP("magic", stats->core.magic)
-	else IFLUA_NUM_MEMB_LOOKUP("defence", stats->core.defence)
-	else IFLUA_NUM_MEMB_LOOKUP("willpower", stats->core.willpower)
-	else IFLUA_NUM_MEMB_LOOKUP("speed", stats->movespeed)
-	else IFLUA_NUM_MEMB_LOOKUP("cooldown_mult", stats->cooldown_mult)
-	else IFLUA_NUM_MEMB_LOOKUP("melee_cooldown_multiplier",
-			stats->cooldown_modifiers.melee_cooldown_multiplier)
-	else IFLUA_NUM_MEMB_LOOKUP("ranged_cooldown_multiplier",
-			stats->cooldown_modifiers.ranged_cooldown_multiplier)
-	else IFLUA_NUM_MEMB_LOOKUP("spell_cooldown_multiplier",
-			stats->cooldown_modifiers.spell_cooldown_multiplier)
-        // Allowed actions are lookup only
-	else IFLUA_NUM_MEMB_LOOKUP("can_use_weapons", stats->allowed_actions.can_use_weapons)
-	else IFLUA_NUM_MEMB_LOOKUP("can_use_spells", stats->allowed_actions.can_use_spells)
-	else IFLUA_NUM_MEMB_LOOKUP("can_use_rest", stats->allowed_actions.can_use_rest)
-	else IFLUA_NUM_MEMB_LOOKUP("can_use_stairs", stats->allowed_actions.can_use_stairs)
-	else {
-		lua_getglobal(L, bind_t::className);
-		int tableind = lua_gettop(L);
-		lua_pushvalue(L, 2);
-		lua_gettable(L, tableind);
-		lua_replace(L, tableind);
-	}
-	return 1;
+	table.push();
 }
-static int lua_member_update(lua_State* L) {
-#define IFLUA_NUM_MEMB_UPDATE(n, m) \
-		if (strncmp(cstr, n, sizeof(n))==0){\
-			m = lua_tonumber(L, 3 );\
-	}
 
-	bind_t* state = lunar_t::check(L, 1);
-	const char* cstr = lua_tostring(L, 2);
-	EffectiveStats* stats = state->get_stats(L);
+template <>
+const char view_t::className[] = "EffectiveStats";
+
+template <>
+StatsField<EffectiveStats> view_t::fields[] = {
+	{"spells", push_spells, NULL},
+	STATS_NUM_FIELD("hp", core.hp),
+	STATS_NUM_FIELD("mp", core.mp),
+	STATS_NUM_FIELD("max_hp", core.max_hp),
+	STATS_NUM_FIELD("max_mp", core.max_mp),
+	STATS_NUM_FIELD("hpregen", core.hpregen),
+	STATS_NUM_FIELD("mpregen", core.mpregen),
+	STATS_NUM_FIELD("strength", core.strength),
+	STATS_NUM_FIELD("spell_velocity_multiplier", core.spell_velocity_multiplier),
+	STATS_NUM_FIELD("magic", core.magic),
+	STATS_NUM_FIELD("defence", core.defence),
+	STATS_NUM_FIELD("willpower", core.willpower),
+	STATS_NUM_FIELD("speed", movespeed),
+	STATS_NUM_FIELD("cooldown_mult", cooldown_mult),
+	STATS_NUM_FIELD("melee_cooldown_multiplier",
+			cooldown_modifiers.melee_cooldown_multiplier),
+	STATS_NUM_FIELD("ranged_cooldown_multiplier",
+			cooldown_modifiers.ranged_cooldown_multiplier),
+	STATS_NUM_FIELD("spell_cooldown_multiplier",
+			cooldown_modifiers.spell_cooldown_multiplier),
+	// Allowed actions are lookup only
+	STATS_NUM_LOOKUP_FIELD("can_use_weapons", allowed_actions.can_use_weapons),
+	STATS_NUM_LOOKUP_FIELD("can_use_spells", allowed_actions.can_use_spells),
+	STATS_NUM_LOOKUP_FIELD("can_use_rest", allowed_actions.can_use_rest),
+	STATS_NUM_LOOKUP_FIELD("can_use_stairs", allowed_actions.can_use_stairs),
+	{NULL, NULL, NULL}
+};
 
-	IFLUA_NUM_MEMB_UPDATE("hp", stats->core.hp)
-	else IFLUA_NUM_MEMB_UPDATE("mp", stats->core.mp)
-	else IFLUA_NUM_MEMB_UPDATE("max_hp", stats->core.max_hp)
-	else IFLUA_NUM_MEMB_UPDATE("max_mp", stats->core.max_mp)
-    else IFLUA_NUM_MEMB_UPDATE("hpregen", stats->core.hpregen)
-    else IFLUA_NUM_MEMB_UPDATE("mpregen", stats->core.mpregen)
-	else IFLUA_NUM_MEMB_UPDATE("strength", stats->core.strength)
-	else IFLUA_NUM_MEMB_UPDATE("spell_velocity_multiplier", stats->core.spell_velocity_multiplier)
-	else IFLUA_NUM_MEMB_UPDATE("magic", stats->core.magic)
-	else IFLUA_NUM_MEMB_UPDATE("defence", stats->core.defence)
-	else IFLUA_NUM_MEMB_UPDATE("willpower", stats->core.willpower)
-	else IFLUA_NUM_MEMB_UPDATE("speed", stats->movespeed)
-	else IFLUA_NUM_MEMB_UPDATE("cooldown_mult", stats->cooldown_mult)
-	else IFLUA_NUM_MEMB_UPDATE("melee_cooldown_multiplier",
-			stats->cooldown_modifiers.melee_cooldown_multiplier)
-	else IFLUA_NUM_MEMB_UPDATE("ranged_cooldown_multiplier",
-			stats->cooldown_modifiers.ranged_cooldown_multiplier)
-	else IFLUA_NUM_MEMB_UPDATE("spell_cooldown_multiplier",
-			stats->cooldown_modifiers.spell_cooldown_multiplier)
-	else {
-		lua_getglobal(L, bind_t::className);
-		int tableind = lua_gettop(L);
-		lua_pushvalue(L, 2);
-		lua_gettable(L, tableind);
-	}
-	return 1;
+template <>
+EffectiveStats& view_t::object_stats(CombatGameInst* inst) {
+	return inst->effective_stats();
 }
 
-meth_t bind_t::methods[] = { meth_t(0, 0) };
-
 void lua_effectivestats_bindings(GameState* gs, lua_State* L) {
-	lunar_t::Register(L);
-
-	luaL_getmetatable(L, bind_t::className);
-
-	int tableind = lua_gettop(L);
-
-	lua_pushstring(L, "__index");
-	lua_pushcfunction(L, lua_member_lookup);
-	lua_settable(L, tableind);
-	lua_pushstring(L, "__newindex");
-	lua_pushcfunction(L, lua_member_update);
-	lua_settable(L, tableind);
+	view_t::register_view(L);
 }
 void lua_push_effectivestats(lua_State* L, GameInst* inst) {
-	lunar_t::push(L, new EffectiveStatsLuaBinding(inst), true);
+	view_t::push(L, inst);
 }
-void lua_push_effectivestats(lua_State* L, const EffectiveStats& stats) {
-	lunar_t::push(L, new EffectiveStatsLuaBinding(stats), true);
+void lua_push_effectivestats(lua_State* L, EffectiveStats& stats) {
+	view_t::push(L, stats);
+}
+void lua_release_effectivestats(lua_State* L, int idx) {
+	view_t::release(L, idx);
 }
 
 void lua_push_effectiveattackstats(lua_State* L,
@@ -203,7 +120,3 @@ EffectiveAttackStats lua_pop_effectiveattackstats(lua_State *L) {
 	lua_pop(L, 1);
 	return stats;
 }
-EffectiveStats& lua_get_effectivestats(lua_State* L, int idx) {
-	return *lunar_t::check(L, idx)->get_stats(L);
-}
-const char EffectiveStatsLuaBinding::className[] = "EffectiveStats";
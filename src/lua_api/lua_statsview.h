@@ -0,0 +1,170 @@
+/*
+ * lua_statsview.h:
+ *  Exposes a stats struct to Lua as a userdata view that reads & writes the
+ *  struct in place. Field names are resolved through a table of accessors
+ *  built once at registration, so a field access is one table lookup.
+ */
+
+#ifndef LUA_STATSVIEW_H_
+#define LUA_STATSVIEW_H_
+
+#include <new>
+#include <lua.hpp>
+
+#include "objects/CombatGameInst.h"
+#include "objects/GameInstRef.h"
+
+template <typename Stats>
+struct StatsField {
+	const char* name;
+	// NULL for update-only fields
+	void (*push)(lua_State* L, Stats& stats);
+	// NULL for lookup-only fields
+	void (*update)(lua_State* L, Stats& stats, int idx);
+};
+
+/* Views either the stats of a combat object, or a struct that is only valid
+ * until release() is called on the view. A view of a const struct ignores
+ * writes. */
+template <typename Stats>
+class LuaStatsView {
+public:
+	static const char className[];
+	static StatsField<Stats> fields[];
+	static Stats& object_stats(CombatGameInst* inst);
+
+	static void register_view(lua_State* L) {
+		luaL_newmetatable(L, className);
+		int metatable = lua_gettop(L);
+
+		// Method table stored in globals, so that scripts can add functions written in Lua
+		lua_newtable(L);
+		int methods = lua_gettop(L);
+		lua_pushvalue(L, methods);
+		lua_setfield(L, LUA_GLOBALSINDEX, className);
+		lua_pushvalue(L, methods);
+		lua_setfield(L, metatable, "__metatable");
+
+		lua_newtable(L);
+		int field_table = lua_gettop(L);
+		for (StatsField<Stats>* field = fields; field->name; field++) {
+			lua_pushlightuserdata(L, field);
+			lua_setfield(L, field_table, field->name);
+		}
+
+		lua_pushvalue(L, field_table);
+		lua_pushvalue(L, methods);
+		lua_pushcclosure(L, lookup, 2);
+		lua_setfield(L, metatable, "__index");
+		lua_pushvalue(L, field_table);
+		lua_pushcclosure(L, update, 1);
+		lua_setfield(L, metatable, "__newindex");
+		lua_pushcfunction(L, tostring);
+		lua_setfield(L, metatable, "__tostring");
+		lua_pushcfunction(L, gc);
+		lua_setfield(L, metatable, "__gc");
+
+		lua_settop(L, metatable - 1);
+	}
+
+	static void push(lua_State* L, GameInst* inst) {
+		new (lua_newuserdata(L, sizeof(LuaStatsView))) LuaStatsView(inst, NULL, false);
+		luaL_getmetatable(L, className);
+		lua_setmetatable(L, -2);
+	}
+
+	static void push(lua_State* L, Stats& stats) {
+		new (lua_newuserdata(L, sizeof(LuaStatsView))) LuaStatsView(NULL, &stats, false);
+		luaL_getmetatable(L, className);
+		lua_setmetatable(L, -2);
+	}
+
+	static void push(lua_State* L, const Stats& stats) {
+		new (lua_newuserdata(L, sizeof(LuaStatsView))) LuaStatsView(NULL,
+				const_cast<Stats*>(&stats), true);
+		luaL_getmetatable(L, className);
+		lua_setmetatable(L, -2);
+	}
+
+	/* Detaches a view of a struct, which then reads as nil */
+	static void release(lua_State* L, int idx) {
+		check(L, idx)->stats = NULL;
+	}
+
+	/* NULL if the view was released or does not refer to a combat object */
+	static Stats* get(lua_State* L, int idx) {
+		LuaStatsView* view = check(L, idx);
+		if (!view->inst.get()) {
+			return view->stats;
+		}
+		CombatGameInst* combat_inst = dynamic_cast<CombatGameInst*>(view->inst.get());
+		return combat_inst ? &object_stats(combat_inst) : NULL;
+	}
+
+private:
+	LuaStatsView(GameInst* inst, Stats* stats, bool readonly) :
+			inst(inst), stats(stats), readonly(readonly) {
+	}
+
+	static LuaStatsView* check(lua_State* L, int idx) {
+		return (LuaStatsView*)luaL_checkudata(L, idx, className);
+	}
+
+	static StatsField<Stats>* find_field(lua_State* L, int field_table) {
+		lua_pushvalue(L, 2);
+		lua_rawget(L, field_table);
+		StatsField<Stats>* field = (StatsField<Stats>*)lua_touserdata(L, -1);
+		lua_pop(L, 1);
+		return field;
+	}
+
+	// Upvalues: field table, method table
+	static int lookup(lua_State* L) {
+		Stats* stats = get(L, 1);
+		if (!stats) {
+			lua_pushnil(L);
+			return 1;
+		}
+		StatsField<Stats>* field = find_field(L, lua_upvalueindex(1));
+		if (field && field->push) {
+			field->push(L, *stats);
+		} else {
+			lua_pushvalue(L, 2);
+			lua_gettable(L, lua_upvalueindex(2));
+		}
+		return 1;
+	}
+
+	// Upvalues: field table. Unknown & lookup-only fields, and writes to a
+	// read-only view, are ignored.
+	static int update(lua_State* L) {
+		Stats* stats = get(L, 1);
+		if (!stats) {
+			return luaL_error(L, "%s view is no longer valid", className);
+		}
+		if (check(L, 1)->readonly) {
+			return 0;
+		}
+		StatsField<Stats>* field = find_field(L, lua_upvalueindex(1));
+		if (field && field->update) {
+			field->update(L, *stats, 3);
+		}
+		return 0;
+	}
+
+	static int tostring(lua_State* L) {
+		lua_pushfstring(L, "%s (%p)", className, (void*)get(L, 1));
+		return 1;
+	}
+
+	static int gc(lua_State* L) {
+		check(L, 1)->~LuaStatsView();
+		return 0;
+	}
+
+	GameInstRef inst; // If inst != NULL, use object stats
+	Stats* stats; // Otherwise, use this
+	bool readonly;
+};
+
+#endif /* LUA_STATSVIEW_H_ */
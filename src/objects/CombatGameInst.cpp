@@ -307,7 +307,7 @@ void CombatGameInst::update_field_of_view(GameState* gs) {
 
 void CombatGameInst::step(GameState* gs) {
     GameInst::step(gs);
-    estats = stats().effective_stats(gs, this);
+    estats = estats_cache.get(gs, this, stats());
     stats().step(gs, this, estats);
 
     // XXX: If we do not sync the new mp & hp values
@@ -10,6 +10,7 @@
 
 #include "pathfind/FloodFillPaths.h"
 #include "stats/combat_stats.h"
+#include "stats/EffectiveStatsCache.h"
 #include "fov/fov.h"
 
 #include "stats/stats.h"
@@ -147,5 +148,6 @@ public:
 private:
 	CombatStats base_stats;
 	EffectiveStats estats;
+	EffectiveStatsCache estats_cache;
 };
 #endif /* COMBATGAMEINST_H_ */
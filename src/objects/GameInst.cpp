@@ -16,6 +16,7 @@
 #include "data/lua_util.h"
 #include "draw/draw_sprite.h"
 
+#include "gamestate/GameMapState.h"
 #include "gamestate/GameState.h"
 
 #include "GameInst.h"
@@ -33,10 +34,27 @@ void GameInst::lua_lookup(lua_State* L, const char* key) {
 	lua_variables[key].push();
 }
 
+bool GameInst::try_callback(lua_callback_t callback) {
+	if (lua_variables.empty() || lua_variables.isnil()) {
+		return false;
+	}
+	if (!lua_callbacks_push(lua_variables, lua_callbacks, callback)) {
+		return false;
+	}
+	lua_State* L = lua_variables.luastate();
+	luawrap::push(L, this);
+	lua_call(L, 1, 0);
+	return true;
+}
+
 bool GameInst::try_callback(const char* callback) {
 	if (lua_variables.empty() || lua_variables.isnil()) {
 		return false;
 	}
+	int slot = lua_callback_by_name(callback);
+	if (slot != -1) {
+		return try_callback((lua_callback_t)slot);
+	}
 
 	lua_State* L = lua_variables.luastate();
 	lua_pushstring(L, callback);
@@ -69,8 +87,17 @@ bool GameInst::try_callback(const char* callback) {
 	return called;
 }
 
+void GameInst::step_lua(LuaStepBatch* batch) {
+	try_callback(CALLBACK_ON_STEP);
+	if (batch) {
+		batch->add(this);
+	}
+}
+
 void GameInst::step(GameState* gs) {
-	try_callback("on_step");
+	// on_step_batch is called once per type, after every instance stepped
+	GameMapState* map = get_map(gs);
+	step_lua(map ? &map->game_inst_set().lua_step_batch() : NULL);
     if (!lua_variables.empty() && !lua_variables.isnil()) {
         lua_State* L = gs->luastate();
         lua_variables["__objectref"].push();
@@ -81,20 +108,20 @@ void GameInst::step(GameState* gs) {
 }
 
 void GameInst::draw(GameState* gs) {
-	try_callback("on_draw");
+	try_callback(CALLBACK_ON_DRAW);
 }
 
 void GameInst::post_draw(GameState* gs) {
-	try_callback("on_post_draw");
+	try_callback(CALLBACK_ON_POST_DRAW);
 }
 
 void GameInst::init(GameState* gs) {
 	current_floor = gs->game_world().get_current_level_id();
-	try_callback("on_map_init");
+	try_callback(CALLBACK_ON_MAP_INIT);
 }
 
 void GameInst::deinit(GameState* gs) {
-	try_callback("on_deinit");
+	try_callback(CALLBACK_ON_DEINIT);
 //        if (!lua_variables.empty() && !lua_variables.isnil()) {
 //            lua_pushnil(gs->luastate());
 //            lua_variables["__objectref"].pop();
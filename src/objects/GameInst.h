@@ -30,9 +30,12 @@
 
 #include "lanarts_defines.h"
 
+#include "LuaCallbackSlots.h"
+
 struct lua_State;
 class GameState;
 class GameMapState;
+class LuaStepBatch;
 class SerializeBuffer;
 //Base class for game instances
 
@@ -71,6 +74,9 @@ public:
 	virtual void update_position(float newx, float newy);
 	virtual std::vector<StatusEffect> base_status_effects(GameState* gs);
 
+	bool try_callback(lua_callback_t callback);
+	/* Calls on_step, then queues the object for its type's on_step_batch */
+	void step_lua(LuaStepBatch* batch);
 	bool try_callback(const char* callback);
 	void lua_lookup(lua_State* L, const char* key);
 	GameMapState* get_map(GameState* gs);
@@ -100,6 +106,8 @@ public:
 	level_id current_floor;
 	// Serialized / deserialized in a separate pass because they have Lua references to objects throughout the system:
 	LuaValue lua_variables;
+	// Hooks of lua_variables, resolved on first use
+	LuaCallbackCache lua_callbacks;
 	EffectStats effects;
 };
 
@@ -0,0 +1,278 @@
+/*
+ * LuaCallbackSlots.cpp:
+ *  The Lua hooks of a GameInst (on_step, on_draw, ...) resolved once per Lua
+ *  type, instead of looked up by name on every call. Hooks that are missing,
+ *  or are 'do_nothing', are cached as absent. Hooks set on the instance table
+ *  itself are still fetched from it on each call.
+ *
+ *  The slots live in the registry of their lua_State. Resolving a type
+ *  watches its tables with a __newindex hook, so a hook added to a type later
+ *  re-resolves that type only. The hook is a metatable shared by all watched
+ *  tables, set only on tables that have no metatable: getmetatable() on such
+ *  a table returns it, and a script setting its own metatable there ends the
+ *  watch. Tables that already have a metatable are never touched.
+ */
+
+#include <map>
+#include <new>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include <luawrap/LuaValue.h>
+
+#include "LuaCallbackSlots.h"
+
+static const char* CALLBACK_NAMES[CALLBACK_AMOUNT] = { "on_step", "on_draw",
+		"on_post_draw", "on_map_init", "on_deinit", "on_wall_bounce",
+		"on_step_batch" };
+
+// Longest __index chain of a type that is watched for new hooks
+static const int MAX_WATCH_DEPTH = 8;
+
+struct TypeSlots {
+	LuaCallbackSlots slots;
+	// Keep the key tables alive, so their addresses are not reused
+	int meta_ref, type_ref;
+	// Tables that a new hook in makes the slots stale
+	std::vector<const void*> watched;
+};
+
+// Keyed by the instance metatable and its 'type' field
+typedef std::pair<const void*, const void*> TypeKey;
+typedef std::map<TypeKey, TypeSlots> TypeSlotsMap;
+
+// Registry keys, by address
+static char slots_key, watcher_key;
+
+static int free_slots(lua_State* L) {
+	((TypeSlotsMap*)lua_touserdata(L, 1))->~TypeSlotsMap();
+	return 0;
+}
+
+/* The slots of the types of 'L', released along with the state */
+static TypeSlotsMap& state_slots(lua_State* L) {
+	lua_pushlightuserdata(L, &slots_key);
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	TypeSlotsMap* map = (TypeSlotsMap*)lua_touserdata(L, -1);
+	lua_pop(L, 1);
+	if (map == NULL) {
+		lua_pushlightuserdata(L, &slots_key);
+		map = new (lua_newuserdata(L, sizeof(TypeSlotsMap))) TypeSlotsMap();
+		lua_newtable(L);
+		lua_pushcfunction(L, free_slots);
+		lua_setfield(L, -2, "__gc");
+		lua_setmetatable(L, -2);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+	}
+	return *map;
+}
+
+static void mark_stale(lua_State* L, const void* table) {
+	TypeSlotsMap& map = state_slots(L);
+	for (TypeSlotsMap::iterator it = map.begin(); it != map.end(); ++it) {
+		std::vector<const void*>& watched = it->second.watched;
+		if (std::find(watched.begin(), watched.end(), table) != watched.end()) {
+			it->second.slots.stale = true;
+		}
+	}
+}
+
+static int watch_newindex(lua_State* L) {
+	if (lua_type(L, 2) == LUA_TSTRING
+			&& lua_callback_by_name(lua_tostring(L, 2)) != -1) {
+		mark_stale(L, lua_topointer(L, 1));
+	}
+	lua_settop(L, 3);
+	lua_rawset(L, 1);
+	return 0;
+}
+
+void lua_callbacks_push_watcher(lua_State* L) {
+	lua_pushlightuserdata(L, &watcher_key);
+	lua_rawget(L, LUA_REGISTRYINDEX);
+	if (lua_isnil(L, -1)) {
+		lua_pop(L, 1);
+		lua_newtable(L);
+		lua_pushcfunction(L, watch_newindex);
+		lua_setfield(L, -2, "__newindex");
+		lua_pushlightuserdata(L, &watcher_key);
+		lua_pushvalue(L, -2);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+	}
+}
+
+/* Watches the table at 'idx' and the tables its metatables' __index lead to.
+ * Tables that already have a metatable of their own are only recorded, for
+ * lua_callbacks_invalidate. Their metatable may be shared with other objects
+ * or define its own __newindex, so it is left as is. */
+static void watch_chain(lua_State* L, int idx, std::vector<const void*>& watched) {
+	int top = lua_gettop(L);
+	lua_pushvalue(L, idx);
+	for (int depth = 0; depth < MAX_WATCH_DEPTH && lua_istable(L, -1); depth++) {
+		const void* table = lua_topointer(L, -1);
+		if (std::find(watched.begin(), watched.end(), table) != watched.end()) {
+			break;
+		}
+		watched.push_back(table);
+		if (!lua_getmetatable(L, -1)) {
+			lua_callbacks_push_watcher(L);
+			lua_setmetatable(L, -2);
+			break;
+		}
+		lua_pushliteral(L, "__index");
+		lua_rawget(L, -2);
+		lua_replace(L, -3); // Replace the table
+		lua_pop(L, 1); // Pop its metatable
+	}
+	lua_settop(L, top);
+}
+
+const char* lua_callback_name(lua_callback_t callback) {
+	return CALLBACK_NAMES[callback];
+}
+
+int lua_callback_by_name(const char* name) {
+	for (int i = 0; i < CALLBACK_AMOUNT; i++) {
+		if (strcmp(CALLBACK_NAMES[i], name) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* Pushes what indexing the object gives for a key it does not hold itself:
+ * its metatable's __index, falling back to its 'type' table. */
+static void push_type_hook(lua_State* L, int obj_idx, int type_idx,
+		const char* name) {
+	lua_pushnil(L);
+	if (lua_getmetatable(L, obj_idx)) {
+		lua_pushliteral(L, "__index");
+		lua_rawget(L, -2);
+		if (lua_isfunction(L, -1)) {
+			lua_pushvalue(L, obj_idx);
+			lua_pushstring(L, name);
+			lua_call(L, 2, 1);
+		} else if (lua_istable(L, -1)) {
+			lua_getfield(L, -1, name);
+			lua_remove(L, -2);
+		} else {
+			lua_pop(L, 1);
+			lua_pushnil(L);
+		}
+		lua_replace(L, -3); // Replace the nil
+		lua_pop(L, 1); // Pop the metatable
+	}
+	if (lua_isnil(L, -1) && lua_istable(L, type_idx)) {
+		lua_pop(L, 1);
+		lua_getfield(L, type_idx, name);
+	}
+}
+
+static void resolve_hooks(lua_State* L, int obj_idx, int type_idx,
+		LuaCallbackSlots& slots) {
+	lua_getglobal(L, "do_nothing");
+	int nothing_idx = lua_gettop(L);
+	for (int i = 0; i < CALLBACK_AMOUNT; i++) {
+		luaL_unref(L, LUA_REGISTRYINDEX, slots.refs[i]);
+		push_type_hook(L, obj_idx, type_idx, CALLBACK_NAMES[i]);
+		if (lua_isnil(L, -1) || lua_rawequal(L, -1, nothing_idx)) {
+			lua_pop(L, 1);
+			slots.refs[i] = LUA_NOREF;
+		} else {
+			slots.refs[i] = luaL_ref(L, LUA_REGISTRYINDEX);
+		}
+	}
+	lua_pop(L, 1);
+	slots.stale = false;
+}
+
+void lua_callbacks_resolve(LuaValue& object, LuaCallbackCache& cache) {
+	if (cache.slots != NULL && !cache.slots->stale) {
+		return;
+	}
+	lua_State* L = object.luastate();
+	int top = lua_gettop(L);
+
+	object.push();
+	int obj_idx = top + 1;
+	if (!lua_getmetatable(L, obj_idx)) {
+		lua_pushnil(L);
+	}
+	int meta_idx = top + 2;
+	lua_pushliteral(L, "type");
+	lua_rawget(L, obj_idx);
+	int type_idx = top + 3;
+
+	TypeSlotsMap& map = state_slots(L);
+	TypeKey key(lua_topointer(L, meta_idx), lua_topointer(L, type_idx));
+	TypeSlotsMap::iterator it = map.find(key);
+	if (it == map.end()) {
+		TypeSlots entry;
+		for (int i = 0; i < CALLBACK_AMOUNT; i++) {
+			entry.slots.refs[i] = LUA_NOREF;
+		}
+		entry.slots.stale = true;
+		lua_pushvalue(L, meta_idx);
+		entry.meta_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+		lua_pushvalue(L, type_idx);
+		entry.type_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+		// The metatable is read by an __index function, or leads to a table
+		if (lua_istable(L, meta_idx)) {
+			watch_chain(L, meta_idx, entry.watched);
+			lua_pushliteral(L, "__index");
+			lua_rawget(L, meta_idx);
+			watch_chain(L, lua_gettop(L), entry.watched);
+			lua_pop(L, 1);
+		}
+		watch_chain(L, type_idx, entry.watched);
+		it = map.insert(std::make_pair(key, entry)).first;
+	}
+	if (it->second.slots.stale) {
+		resolve_hooks(L, obj_idx, type_idx, it->second.slots);
+	}
+
+	cache.slots = &it->second.slots;
+	cache.own_mask = 0;
+	for (int i = 0; i < CALLBACK_AMOUNT; i++) {
+		lua_pushstring(L, CALLBACK_NAMES[i]);
+		lua_rawget(L, obj_idx);
+		if (!lua_isnil(L, -1)) {
+			cache.own_mask |= (1u << i);
+		}
+		lua_pop(L, 1);
+	}
+	lua_settop(L, top);
+}
+
+bool lua_callbacks_push(LuaValue& object, LuaCallbackCache& cache,
+		lua_callback_t callback) {
+	lua_callbacks_resolve(object, cache);
+	lua_State* L = object.luastate();
+	if (cache.own_mask & (1u << callback)) {
+		object.push();
+		lua_pushstring(L, CALLBACK_NAMES[callback]);
+		lua_rawget(L, -2);
+		lua_remove(L, -2);
+		if (!lua_isnil(L, -1)) {
+			return true;
+		}
+		lua_pop(L, 1); // Since removed, fall back to the type
+	}
+	int ref = cache.slots->refs[callback];
+	if (ref == LUA_NOREF) {
+		return false;
+	}
+	lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+	return true;
+}
+
+void lua_callbacks_instance_changed(LuaCallbackCache& cache,
+		lua_callback_t callback) {
+	cache.own_mask |= (1u << callback);
+}
+
+void lua_callbacks_invalidate(lua_State* L, int idx) {
+	mark_stale(L, lua_topointer(L, idx));
+}
@@ -0,0 +1,67 @@
+/*
+ * LuaCallbackSlots.h:
+ *  The Lua hooks of a GameInst (on_step, on_draw, ...) resolved once per Lua
+ *  type, instead of looked up by name on every call. Hooks that are missing,
+ *  or are 'do_nothing', are cached as absent. Hooks set on the instance table
+ *  itself are still fetched from it on each call.
+ *
+ *  The slots live in the registry of their lua_State. Resolving a type
+ *  watches its tables with a __newindex hook, so a hook added to a type later
+ *  re-resolves that type only. The hook is a shared metatable, installed only
+ *  on type tables without a metatable of their own.
+ */
+
+#ifndef LUACALLBACKSLOTS_H_
+#define LUACALLBACKSLOTS_H_
+
+#include <lua.hpp>
+
+class LuaValue;
+
+enum lua_callback_t {
+	CALLBACK_ON_STEP,
+	CALLBACK_ON_DRAW,
+	CALLBACK_ON_POST_DRAW,
+	CALLBACK_ON_MAP_INIT,
+	CALLBACK_ON_DEINIT,
+	CALLBACK_ON_WALL_BOUNCE,
+	// Per type only, see LuaStepBatch
+	CALLBACK_ON_STEP_BATCH,
+	CALLBACK_AMOUNT
+};
+
+const char* lua_callback_name(lua_callback_t callback);
+/* Returns -1 if 'name' is not a hook */
+int lua_callback_by_name(const char* name);
+
+struct LuaCallbackSlots {
+	int refs[CALLBACK_AMOUNT]; // Registry refs, LUA_NOREF if absent
+	bool stale; // Re-resolved by the next lua_callbacks_resolve
+};
+
+/* Per instance view of the slots of its type */
+struct LuaCallbackCache {
+	LuaCallbackCache() :
+			slots(NULL), own_mask(0) {
+	}
+	LuaCallbackSlots* slots;
+	unsigned int own_mask; // Hooks set on the instance table itself
+};
+
+/* Resolves the hooks for 'object' if its cache is out of date */
+void lua_callbacks_resolve(LuaValue& object, LuaCallbackCache& cache);
+/* Pushes the hook, or returns false if absent */
+bool lua_callbacks_push(LuaValue& object, LuaCallbackCache& cache,
+		lua_callback_t callback);
+/* Must be called when a hook is set on an instance table after it resolved */
+void lua_callbacks_instance_changed(LuaCallbackCache& cache,
+		lua_callback_t callback);
+/* Marks the type table at 'idx' for re-resolving. Only needed when a hook the
+ * table already holds is replaced, which does not trigger __newindex, or when
+ * the table has a metatable of its own and so is not watched. */
+void lua_callbacks_invalidate(lua_State* L, int idx);
+/* Pushes the metatable set on watched type tables, so that serialization can
+ * reach it by name */
+void lua_callbacks_push_watcher(lua_State* L);
+
+#endif /* LUACALLBACKSLOTS_H_ */
@@ -32,6 +32,10 @@
 
 const int HUGE_DISTANCE = 1000000;
 
+// Monsters further than this (in x or y) from every player-team actor cannot
+// start chasing, which needs them within a view centred on the actor
+const int MONSTER_WAKE_DISTANCE = PLAYER_PATHING_RADIUS + TILE_SIZE * 2;
+
 MonsterController::MonsterController(bool wander) :
         monsters_wandering_flag(wander) {
 }
@@ -111,6 +115,62 @@ CombatGameInst* MonsterController::find_actor_to_target(GameState* gs, EnemyInst
     return closest_actor;
 }
 
+void monster_wake_query(GameInstSet& insts, const std::vector<GameInst*>& wakers,
+        int distance, std::vector<obj_id>& ids) {
+    std::vector<GameInst*> nearby;
+    for (int i = 0; i < wakers.size(); i++) {
+        GameInst* waker = wakers[i];
+        BBox area(waker->x - distance, waker->y - distance,
+                waker->x + distance, waker->y + distance);
+        insts.object_rectangle_test(area, nearby, waker);
+    }
+    ids.clear();
+    for (int i = 0; i < nearby.size(); i++) {
+        ids.push_back(nearby[i]->id);
+    }
+    std::sort(ids.begin(), ids.end());
+}
+
+// Finds the monsters near any player or player ally, through the spatial grid
+void MonsterController::find_woken_monsters(GameState* gs) {
+    GameMapState* level = gs->get_level();
+    woken_mids.clear();
+    waking_teams.clear();
+    for (int i = 0; i < players.size(); i++) {
+        team_id team = players[i]->team;
+        if (std::find(waking_teams.begin(), waking_teams.end(), team) == waking_teams.end()) {
+            waking_teams.push_back(team);
+        }
+    }
+
+    std::vector<GameInst*> wakers;
+    for (int i = 0; i < waking_teams.size(); i++) {
+        for_all_on_team(gs->team_data(), level->id(), waking_teams[i], [&](CombatGameInst* actor) {
+            wakers.push_back(actor);
+        });
+    }
+    monster_wake_query(level->game_inst_set(), wakers, MONSTER_WAKE_DISTANCE, woken_mids);
+}
+
+// Idle monsters far from every player-team actor sleep: they skip targeting,
+// wandering & steering until one comes near or they are hurt. Their Lua step
+// event still runs.
+bool MonsterController::is_sleeping(GameState* gs, EnemyInst* e) {
+    EnemyBehaviour& eb = e->behaviour();
+    if (eb.current_action != EnemyBehaviour::INACTIVE || eb.chase_timeout > 0
+            || e->cooldowns().is_hurting()) {
+        return false;
+    }
+    // Nothing sleeps if there are no players at all
+    if (gs->player_data().all_players().empty()) {
+        return false;
+    }
+    if (std::find(waking_teams.begin(), waking_teams.end(), e->team) != waking_teams.end()) {
+        return false;
+    }
+    return !std::binary_search(woken_mids.begin(), woken_mids.end(), e->id);
+}
+
 void MonsterController::pre_step(GameState* gs) {
     perf_timer_begin(FUNCNAME);
 
@@ -118,6 +178,8 @@ void MonsterController::pre_step(GameState* gs) {
     std::vector<EnemyOfInterest> eois;
 
     players = gs->players_in_level();
+    find_woken_monsters(gs);
+    sleeping.clear();
 
     //Update 'mids' to only hold live objects
     std::vector<obj_id> mids2;
@@ -133,6 +195,11 @@ void MonsterController::pre_step(GameState* gs) {
 
         //Add live instances back to monster id list
         mids.push_back(mids2[i]);
+        sleeping.push_back(is_sleeping(gs, e));
+        if (sleeping.back()) {
+            e->vx = 0, e->vy = 0;
+            continue;
+        }
 
         CombatGameInst* actor = find_actor_to_target(gs, e);
 
@@ -198,18 +265,25 @@ void MonsterController::pre_step(GameState* gs) {
                 if (!e) {
                     continue;
                 }
+        simul_id simid = e->collision_simulation_id();
         lua_State* L = gs->luastate();
         lua_gameinst_callback(L, e->etype().step_event.get(L), e);
+        if (sleeping[i]) {
+            // Still an obstacle to others, but with no will of its own
+            coll_avoid.set_preferred_velocity(simid, 0, 0);
+            coll_avoid.set_position(simid, e->rx, e->ry);
+            continue;
+        }
         update_velocity(gs, e);
-        simul_id simid = e->collision_simulation_id();
         coll_avoid.set_position(simid, e->rx, e->ry);
     }
 
+    coll_avoid.update_walls(gs->tiles());
     coll_avoid.step();
 
     for (int i = 0; i < mids.size(); i++) {
         EnemyInst* e = (EnemyInst*)gs->get_instance(mids[i]);
-                if (!e) {
+                if (!e || sleeping[i]) {
                     continue;
                 }
         update_position(gs, e);
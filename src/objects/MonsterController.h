@@ -35,8 +35,14 @@ struct RVOSimulator;
 }
 
 class GameMapState;
+class GameInstSet;
 class PlayerInst;
 
+/* Sorted ids of the instances within 'distance' (in x or y) of any of
+ * 'wakers', other than the waker itself. Ids can repeat. */
+void monster_wake_query(GameInstSet& insts, const std::vector<GameInst*>& wakers,
+		int distance, std::vector<obj_id>& ids);
+
 class MonsterController {
 public:
 	MonsterController(bool wander = true);
@@ -71,6 +77,8 @@ private:
 	void update_velocity(GameState* gs, EnemyInst* e);
 	/*returns an index into the player_simids vector*/
 	CombatGameInst* find_actor_to_target(GameState* gs, EnemyInst* e);
+	void find_woken_monsters(GameState* gs);
+	bool is_sleeping(GameState* gs, EnemyInst* e);
 	void monster_wandering(GameState *gs, EnemyInst *e);
 	void monster_follow_path(GameState *gs, EnemyInst *e);
 	void monster_get_to_stairs(GameState *gs, EnemyInst *e);
@@ -80,6 +88,11 @@ private:
 	std::vector<PlayerInst*> players;
 	std::vector<obj_id> mids;
 
+	/* Recomputed every step, so sleep needs no serialization */
+	std::vector<team_id> waking_teams;
+	std::vector<obj_id> woken_mids; // sorted
+	std::vector<bool> sleeping; // parallel to mids
+
 	bool monsters_wandering_flag;
 };
 
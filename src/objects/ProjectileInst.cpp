@@ -161,7 +161,7 @@ void ProjectileInst::step(GameState* gs) {
 				vx = -vx;
 				vy = -vy;
 			}
-			try_callback("on_wall_bounce");
+			try_callback(CALLBACK_ON_WALL_BOUNCE);
 		}
 	} else if (collides) {
 		gs->remove_instance(this);
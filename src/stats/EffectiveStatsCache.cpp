@@ -0,0 +1,125 @@
+/*
+ * EffectiveStatsCache.cpp:
+ *  Keeps the effective stats of a combat object between frames, recomputing
+ *  them only when the stats they were derived from change.
+ */
+
+#include "items/EquipmentEntry.h"
+#include "objects/CombatGameInst.h"
+
+#include "combat_stats.h"
+#include "effect_data.h"
+#include "stat_formulas.h"
+
+#include "EffectiveStatsCache.h"
+
+static EffectiveStatsCacheCounts cache_counts = {0, 0, 0};
+
+EffectiveStatsCacheCounts effective_stats_cache_counts() {
+	return cache_counts;
+}
+
+// Everything in CoreStats that is not spent & regenerated from frame to frame
+static bool same_base_core(const CoreStats& a, const CoreStats& b) {
+	return a.max_hp == b.max_hp && a.max_mp == b.max_mp
+			&& a.hp_bleed == b.hp_bleed && a.mp_bleed == b.mp_bleed
+			&& a.strength == b.strength && a.defence == b.defence
+			&& a.magic == b.magic && a.willpower == b.willpower
+			&& a.hpregen == b.hpregen && a.mpregen == b.mpregen
+			&& a.spell_velocity_multiplier == b.spell_velocity_multiplier;
+}
+
+// Resistances with a random base are rolled again every frame
+static bool has_fixed_resistances(EquipmentEntry& entry) {
+	return entry.resistance().base.min == entry.resistance().base.max
+			&& entry.magic_resistance().base.min == entry.magic_resistance().base.max;
+}
+
+bool EffectiveStatsCache::inputs_match(CombatGameInst* inst,
+		const CombatStats& stats, bool& cacheable) const {
+	bool match = _valid;
+	cacheable = true;
+
+	size_t n_active = 0;
+	for (const Effect& eff : inst->effects.effects) {
+		if (!eff.is_active()) {
+			continue;
+		}
+		EffectEntry& entry = game_effect_data.get(eff.id);
+		if (entry.dynamic_stats && !entry.stat_func.isnil()) {
+			cacheable = false;
+			return false;
+		}
+		match = match && n_active < _active_effects.size()
+				&& _active_effects[n_active] == eff.id;
+		n_active++;
+	}
+	match = match && n_active == _active_effects.size();
+
+	size_t n_equipped = 0;
+	for (const ItemSlot& slot : stats.equipment.inventory.raw_slots()) {
+		if (!slot.is_equipped()) {
+			continue;
+		}
+		if (!has_fixed_resistances(slot.equipment_entry())) {
+			cacheable = false;
+			return false;
+		}
+		match = match && n_equipped < _equipped.size()
+				&& _equipped[n_equipped] == slot.item.id;
+		n_equipped++;
+	}
+	match = match && n_equipped == _equipped.size();
+
+	return match && same_base_core(stats.core, _core)
+			&& stats.movespeed == _movespeed
+			&& stats.class_stats.classid == _classid
+			&& stats.class_stats.xplevel == _xplevel
+			&& stats.spells.spell_id_list() == _spells;
+}
+
+void EffectiveStatsCache::record_inputs(CombatGameInst* inst,
+		const CombatStats& stats) {
+	_core = stats.core;
+	_movespeed = stats.movespeed;
+	_classid = stats.class_stats.classid;
+	_xplevel = stats.class_stats.xplevel;
+	_spells = stats.spells.spell_id_list();
+
+	_equipped.clear();
+	for (const ItemSlot& slot : stats.equipment.inventory.raw_slots()) {
+		if (slot.is_equipped()) {
+			_equipped.push_back(slot.item.id);
+		}
+	}
+	_active_effects.clear();
+	for (const Effect& eff : inst->effects.effects) {
+		if (eff.is_active()) {
+			_active_effects.push_back(eff.id);
+		}
+	}
+	_valid = true;
+}
+
+const EffectiveStats& EffectiveStatsCache::get(GameState* gs,
+		CombatGameInst* inst, const CombatStats& stats) {
+	bool cacheable = false;
+	if (inputs_match(inst, stats, cacheable)) {
+		cache_counts.hits++;
+		// As effective_stats would, take the current hp & mp
+		CoreStats& core = _stats.core;
+		core.hp = stats.core.hp, core.mp = stats.core.mp;
+		core.hp_regened = stats.core.hp_regened, core.mp_regened = stats.core.mp_regened;
+		return _stats;
+	}
+
+	_stats = effective_stats(gs, inst, stats);
+	if (cacheable) {
+		cache_counts.misses++;
+		record_inputs(inst, stats);
+	} else {
+		cache_counts.dynamic++;
+		_valid = false;
+	}
+	return _stats;
+}
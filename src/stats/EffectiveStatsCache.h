@@ -0,0 +1,55 @@
+/*
+ * EffectiveStatsCache.h:
+ *  Keeps the effective stats of a combat object between frames, recomputing
+ *  them only when the stats they were derived from change.
+ */
+
+#ifndef EFFECTIVESTATSCACHE_H_
+#define EFFECTIVESTATSCACHE_H_
+
+#include <vector>
+
+#include "lanarts_defines.h"
+
+#include "stats.h"
+
+class CombatGameInst;
+class GameState;
+struct CombatStats;
+
+/* Counts over all caches, for profiling */
+struct EffectiveStatsCacheCounts {
+	long long hits, misses;
+	// Recomputed because a per-frame-dynamic effect or random equipment was involved
+	long long dynamic;
+};
+
+class EffectiveStatsCache {
+public:
+	/* Same result as effective_stats(gs, inst, stats). Reused while the base
+	 * stats (other than hp & mp), class level, spells, equipped items and
+	 * active effects are unchanged. Effects with a stat_func are per-frame
+	 * dynamic unless their entry sets 'dynamic_stats' to false. */
+	const EffectiveStats& get(GameState* gs, CombatGameInst* inst,
+			const CombatStats& stats);
+private:
+	bool inputs_match(CombatGameInst* inst, const CombatStats& stats,
+			bool& cacheable) const;
+	void record_inputs(CombatGameInst* inst, const CombatStats& stats);
+
+	bool _valid = false;
+	/* Inputs of the cached stats */
+	CoreStats _core;
+	float _movespeed = 0;
+	class_id _classid = -1;
+	int _xplevel = 0;
+	std::vector<spell_id> _spells;
+	std::vector<item_id> _equipped;
+	std::vector<effect_id> _active_effects;
+
+	EffectiveStats _stats;
+};
+
+EffectiveStatsCacheCounts effective_stats_cache_counts();
+
+#endif /* EFFECTIVESTATSCACHE_H_ */
@@ -24,7 +24,7 @@ public:
 		return spells.size();
 	}
 
-	const std::vector<spell_id>& spell_id_list() {
+	const std::vector<spell_id>& spell_id_list() const {
 		return spells;
 	}
 
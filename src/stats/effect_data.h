@@ -18,6 +18,9 @@
 struct EffectEntry {
 	std::string name, category;
 	LuaValue stat_func, draw_func, attack_stat_func, init_func, step_func;
+	// Optional, steps all of a level's active instances of this effect at once.
+	// Called as step_batch_func(states, objects), in place of step_func.
+	LuaValue step_batch_func;
 	// TODO Move rest to lua only ^
     // For stat listings when hovering over items:
     LuaValue console_draw_func;
@@ -38,6 +41,9 @@ struct EffectEntry {
 	AllowedActions allowed_actions;
 	int fade_out = 0;
 	bool additive_duration = false;
+	// Whether stat_func can give a different result from frame to frame, or
+	// has side effects. When false, effective stats are reused between frames.
+	bool dynamic_stats = true;
 };
 
 effect_id get_effect_by_name(const char* name);
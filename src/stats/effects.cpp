@@ -7,6 +7,7 @@
 #include <lcommon/luaserialize.h>
 
 #include "data/lua_game_data.h"
+#include "gamestate/GameMapState.h"
 #include "gamestate/GameState.h"
 
 #include "lua_api/lua_api.h"
@@ -130,7 +131,10 @@ void EffectStats::process(GameState* gs, CombatGameInst* inst,
     if (!has_active_effect())
         return;
     lua_State* L = gs->luastate();
-    lua_push_combatstats(L, inst->stats());
+    // Effects modify 'effective' in place, through a view released once they are done.
+    // The base stats are only read, writes to them are ignored.
+    const CombatStats& base = inst->stats();
+    lua_push_combatstats(L, base);
     lua_push_effectivestats(L, effective);
 
     int affind = lua_gettop(L);
@@ -152,8 +156,8 @@ void EffectStats::process(GameState* gs, CombatGameInst* inst,
             lua_call(L, 4, 0);
         }
     }
-//    basestats = lua_get_combatstats(L, baseind);
-    effective = lua_get_effectivestats(L, affind);
+    lua_release_combatstats(L, baseind);
+    lua_release_effectivestats(L, affind);
     lua_pop(L, 2);
     //pop base&affected
 }
@@ -217,13 +221,18 @@ void EffectStats::step(GameState* gs, GameInst* inst) {
             }
         }
     }
-    // Step for every effect in the game:
+    // Step for every effect in the game. Effects with a step_batch_func are
+    // stepped together, once all of the level's objects have stepped.
+    GameMapState* map = inst->get_map(gs);
     for (int i = 0; i < effects.size(); i++) {
         Effect& eff = effects[i];
         if (!eff.is_active()) {
             continue;
         }
         EffectEntry& entry = game_effect_data.get(eff.id);
+        if (map && map->game_inst_set().effect_step_batch().add(inst, eff)) {
+            continue;
+        }
         lua_effect_func_callback(L, entry.step_func, eff.state, inst);
     }
 }
@@ -251,6 +260,13 @@ Effect* EffectStats::get_active(const char* name) {
     return NULL;
 }
 
+Effect& EffectStats::new_effect(GameState* gs, GameInst* inst, effect_id id) {
+    Effect& eff = effects.new_entry();
+    eff.id = id;
+    lua_init_effect(gs->luastate(), eff.state, inst, id);
+    return eff;
+}
+
 Effect& EffectStats::get(GameState* gs, GameInst* inst, effect_id id) {
     for (int i = 0; i < effects.size(); i++) {
         Effect& eff = effects[i];
@@ -258,11 +274,7 @@ Effect& EffectStats::get(GameState* gs, GameInst* inst, effect_id id) {
             return eff;
         }
     }
-    effects.push_back(Effect());
-    effects.back().id = id;
-    lua_init_effect(gs->luastate(), effects.back().state, inst, id);
-
-    return effects.back();
+    return new_effect(gs, inst, id);
 }
 
 Effect& EffectStats::get(GameState* gs, GameInst* inst, const char* name) {
@@ -273,12 +285,7 @@ Effect& EffectStats::get(GameState* gs, GameInst* inst, const char* name) {
             return eff;
         }
     }
-
-    effects.push_back(Effect());
-    effects.back().id = get_effect_by_name(name);
-    lua_init_effect(gs->luastate(), effects.back().state, inst, effects.back().id);
-
-    return effects.back();
+    return new_effect(gs, inst, get_effect_by_name(name));
 }
 
 bool EffectStats::has_category(const char* category) {
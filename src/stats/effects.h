@@ -4,6 +4,7 @@
 #include <luawrap/LuaValue.h>
 #include <ldraw/Colour.h>
 
+#include <algorithm>
 #include <vector>
 #include "stats/stat_modifiers.h"
 #include "lanarts_defines.h"
@@ -53,6 +54,106 @@ struct Effect {
         return state["time_left"].as<int>();
     }
 };
+/* Storage for the effects of one object. The first EFFECTS_MAX entries are
+ * kept inline, so that adding an effect does not allocate for all but a few
+ * objects. Entries past that spill into a vector, so no effect is dropped. */
+class EffectArray {
+public:
+    template <typename A, typename E>
+    struct Iterator {
+        A* array;
+        int i;
+        E& operator*() const {
+            return (*array)[i];
+        }
+        E* operator->() const {
+            return &(*array)[i];
+        }
+        Iterator& operator++() {
+            i++;
+            return *this;
+        }
+        bool operator!=(const Iterator& o) const {
+            return i != o.i;
+        }
+        bool operator==(const Iterator& o) const {
+            return i == o.i;
+        }
+    };
+    typedef Iterator<EffectArray, Effect> iterator;
+    typedef Iterator<const EffectArray, const Effect> const_iterator;
+
+    EffectArray() : _size(0) {
+    }
+    int size() const {
+        return _size;
+    }
+    Effect& operator[](int i) {
+        return i < EFFECTS_MAX ? _effects[i] : _overflow[i - EFFECTS_MAX];
+    }
+    const Effect& operator[](int i) const {
+        return i < EFFECTS_MAX ? _effects[i] : _overflow[i - EFFECTS_MAX];
+    }
+    Effect& at(int i) {
+        LANARTS_ASSERT(i >= 0 && i < _size);
+        return (*this)[i];
+    }
+    Effect& back() {
+        return (*this)[_size - 1];
+    }
+    iterator begin() {
+        return {this, 0};
+    }
+    iterator end() {
+        return {this, _size};
+    }
+    const_iterator begin() const {
+        return {this, 0};
+    }
+    const_iterator end() const {
+        return {this, _size};
+    }
+    void push_back(const Effect& effect) {
+        if (_size < EFFECTS_MAX) {
+            _effects[_size] = effect;
+        } else {
+            _overflow.push_back(effect);
+        }
+        _size++;
+    }
+    // Entries past 'size' are reset, releasing their state.
+    void resize(int size) {
+        size = std::max(0, size);
+        for (int i = size; i < std::min(_size, EFFECTS_MAX); i++) {
+            _effects[i] = Effect();
+        }
+        _overflow.resize(std::max(0, size - EFFECTS_MAX));
+        _size = size;
+    }
+    void clear() {
+        resize(0);
+    }
+    // Returns a reset entry for a new effect. Once EFFECTS_MAX entries are in
+    // use, the first inactive entry is reused before the array grows further.
+    Effect& new_entry() {
+        if (_size >= EFFECTS_MAX) {
+            for (int i = 0; i < _size; i++) {
+                Effect& eff = (*this)[i];
+                if (!eff.is_active()) {
+                    eff = Effect();
+                    return eff;
+                }
+            }
+        }
+        push_back(Effect());
+        return back();
+    }
+private:
+    Effect _effects[EFFECTS_MAX];
+    std::vector<Effect> _overflow;
+    int _size;
+};
+
 struct EffectStats {
     bool has_active_effect() const;
     LuaValue add(GameState* gs, GameInst* inst, StatusEffect effect);
@@ -87,7 +188,9 @@ struct EffectStats {
             }
         }
     }
-    std::vector<Effect> effects;
+    EffectArray effects;
+private:
+    Effect& new_effect(GameState* gs, GameInst* inst, effect_id id);
 };
 
 // Design decisions:
@@ -95,6 +198,8 @@ struct EffectStats {
 //     Rationale:
 //     - Monsters will die before too much accumulation
 //     - Players/applicable effects are few in number
+//  Once EFFECTS_MAX effects were applied, inactive entries are reused.
+//  Only when all of them are active does the array grow past EFFECTS_MAX.
 
 
 #endif // EFFECTS_H
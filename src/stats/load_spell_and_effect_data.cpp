@@ -43,6 +43,7 @@ static EffectEntry parse_effect(const LuaStackValue& table) {
     entry.stat_func = table["stat_func"];
     entry.attack_stat_func = table["attack_stat_func"];
     entry.step_func = table["step_func"];
+    entry.step_batch_func = table["step_batch_func"];
 
     entry.console_draw_func = table["console_draw_func"];
     entry.remove_func = table["remove_func"];
@@ -69,6 +70,8 @@ static EffectEntry parse_effect(const LuaStackValue& table) {
     entry.allowed_actions.can_use_items = defaulted(table, "can_use_items", true);
     entry.allowed_actions.can_use_weapons = defaulted(table, "can_use_weapons", true);
 
+    entry.dynamic_stats = defaulted(table, "dynamic_stats", true);
+
     entry.effected_colour = defaulted(table, "effected_colour", Colour());
     if (!table["effected_sprite"].isnil()) {
         entry.effected_sprite = res::sprite_id(table["effected_sprite"].to_str());
@@ -0,0 +1,214 @@
+#include <map>
+#include <string>
+
+#include <lua.hpp>
+
+#include <lcommon/unittest.h>
+#include <lcommon/mtwist.h>
+#include <lcommon/lua_lcommon.h>
+
+#include <luawrap/luawrap.h>
+#include <luawrap/testutils.h>
+
+#include <ldungeon_gen/Map.h>
+#include <ldungeon_gen/AreaTemplate.h>
+#include <ldungeon_gen/lua_ldungeon.h>
+
+#include <lua_api/lua_api.h>
+
+using namespace ldungeon_gen;
+
+/* AreaTemplate as it was before it compiled its glyphs per orientation:
+ * every call looks up each square's glyph and reorients it on the fly.
+ * Kept to check that the compiled form places & matches the same. */
+struct ReferenceTemplate {
+	Size size;
+	std::string data; // Glyph rows of 'size.w', without newlines
+	std::map<char, Glyph> legend;
+
+	Pos reorient(Pos xy, Orientation orientation) const {
+		int negx = size.w - xy.x - 1, negy = size.h - xy.y - 1;
+		switch (orientation) {
+		case ORIENT_FLIP_X:
+			return Pos(negx, xy.y);
+		case ORIENT_FLIP_Y:
+			return Pos(xy.x, negy);
+		case ORIENT_TURN_90:
+			return Pos(xy.y, negx);
+		case ORIENT_TURN_180:
+			return Pos(negx, negy);
+		case ORIENT_TURN_270:
+			return Pos(negy, xy.x);
+		default:
+			return xy;
+		}
+	}
+
+	void apply(MapPtr map, const Pos& xy, Orientation orientation) {
+		lua_State* L = NULL;
+		FOR_EACH_BBOX(BBox(Pos(), size), x, y) {
+			Pos sqr = xy + reorient(Pos(x, y), orientation);
+			Glyph& glyph = legend[data[y * size.w + x]];
+			(*map)[sqr].apply(glyph.oper.oper);
+			if (!glyph.value.empty() && !glyph.value.isnil()) {
+				if (L == NULL) {
+					L = glyph.value.luastate();
+					luawrap::push(L, map);
+				}
+				LuaStackValue mapval(L, -1);
+				glyph.value.push();
+				mapval.push();
+				luawrap::push(L, sqr);
+				lua_call(L, 2, 0);
+			}
+		}
+		if (L) {
+			lua_pop(L, 1);
+		}
+	}
+
+	bool matches(MapPtr map, const Pos& xy, Orientation orientation) {
+		FOR_EACH_BBOX(BBox(Pos(), size), x, y) {
+			Pos sqr = xy + reorient(Pos(x, y), orientation);
+			if (sqr.x < 0 || sqr.x >= map->width() || sqr.y < 0 || sqr.y >= map->height()) {
+				return false;
+			}
+			if (!(*map)[sqr].matches(legend[data[y * size.w + x]].oper.selector)) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+static bool same_map(Map& a, Map& b) {
+	FOR_EACH_BBOX(BBox(Pos(), a.size()), x, y) {
+		Square& sa = a[Pos(x, y)], & sb = b[Pos(x, y)];
+		if (sa.flags != sb.flags || sa.content != sb.content || sa.group != sb.group) {
+			return false;
+		}
+	}
+	return a.groups.size() == b.groups.size();
+}
+
+/* An event that reads the map, so the order of placement shows in the log */
+static const char* EVENT_CODE =
+		"log = {}\n"
+		"function event(map, xy)\n"
+		"    log[#log + 1] = xy[1] .. ',' .. xy[2] .. ':' .. map:get(xy).flags .. '/' .. map:get({0, 0}).flags\n"
+		"    map:square_apply(xy, {add = 128})\n"
+		"end\n"
+		"function take_log() local s = table.concat(log, ' ') log = {} return s end\n";
+
+static std::string take_log(lua_State* L) {
+	lua_getglobal(L, "take_log");
+	lua_call(L, 0, 1);
+	std::string log = lua_tostring(L, -1);
+	lua_pop(L, 1);
+	return log;
+}
+
+SUITE(AreaTemplate_tests) {
+	TEST(area_template_orientations) {
+		/* 'a' in the top left, 'b' in the bottom left of a 3x2 template */
+		AreaTemplate temp("a..\nb..\n", Size(3, 2));
+		temp.define_glyph('.', Glyph(ConditionalOperator(Selector(0, 0), Operator(0, 0, 0, 0))));
+		temp.define_glyph('a', Glyph(ConditionalOperator(Selector(0, 0), Operator(0, 0, 0, 1))));
+		temp.define_glyph('b', Glyph(ConditionalOperator(Selector(FLAG_SOLID), Operator(0, 0, 0, 2))));
+
+		const Orientation orientations[] = {ORIENT_DEFAULT, ORIENT_FLIP_X, ORIENT_FLIP_Y,
+				ORIENT_TURN_90, ORIENT_TURN_180, ORIENT_TURN_270};
+		/* Where 'a' and 'b' end up, relative to the top left */
+		const Pos a_xy[] = {Pos(0, 0), Pos(2, 0), Pos(0, 1), Pos(0, 2), Pos(2, 1), Pos(1, 0)};
+		const Pos b_xy[] = {Pos(0, 1), Pos(2, 1), Pos(0, 0), Pos(1, 2), Pos(2, 0), Pos(0, 0)};
+		for (int i = 0; i < 6; i++) {
+			MapPtr map(new Map(Size(5, 5), Square(FLAG_SOLID, 9)));
+			CHECK(temp.matches(map, ROOT_GROUP_ID, Pos(1, 1), orientations[i]));
+			CHECK(!temp.matches(map, ROOT_GROUP_ID, Pos(3, 3), orientations[i]));
+			temp.apply(map, ROOT_GROUP_ID, Pos(1, 1), orientations[i], false);
+
+			Size size = temp.size();
+			if (orientations[i] == ORIENT_TURN_90 || orientations[i] == ORIENT_TURN_270) {
+				size = Size(size.h, size.w);
+			}
+			FOR_EACH_BBOX(BBox(Pos(0, 0), map->size()), x, y) {
+				Pos xy(x - 1, y - 1);
+				int content = (*map)[Pos(x, y)].content;
+				if (xy == a_xy[i]) {
+					CHECK_EQUAL(1, content);
+				} else if (xy == b_xy[i]) {
+					CHECK_EQUAL(2, content);
+				} else if (BBox(Pos(0, 0), size).contains(xy)) {
+					CHECK_EQUAL(0, content);
+				} else {
+					CHECK_EQUAL(9, content);
+				}
+			}
+
+			/* 'b' only matches solid squares */
+			MapPtr open_map(new Map(Size(5, 5)));
+			CHECK(!temp.matches(open_map, ROOT_GROUP_ID, Pos(1, 1), orientations[i]));
+		}
+	}
+
+	TEST(area_template_matches_reference) {
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			luaL_openlibs(L);
+			lua_register_lcommon(L);
+			lua_settop(L, 0);
+			LuaValue map_gen = lua_api::register_lua_submodule(L, "core.SourceMap");
+			lua_register_ldungeon(map_gen, false);
+			lua_assert_valid_dostring(L, EVENT_CODE);
+			LuaValue event = luawrap::globals(L)["event"];
+
+			MTwist rng(11);
+			for (int trial = 0; trial < 500; trial++) {
+				Size size(rng.rand(1, 8), rng.rand(1, 8));
+				std::string data, rows;
+				for (int y = 0; y < size.h; y++) {
+					for (int x = 0; x < size.w; x++) {
+						data += "abcd"[rng.rand(4)];
+					}
+					rows += data.substr(y * size.w, size.w) + "\n";
+				}
+				AreaTemplate temp(rows.c_str(), size);
+				ReferenceTemplate reference = {size, data};
+				bool events = rng.rand(2);
+				for (char c = 'a'; c <= 'c'; c++) {
+					ConditionalOperator oper(Selector(rng.rand(4), rng.rand(4) & 4),
+							Operator(rng.rand(8), rng.rand(8), rng.rand(4), rng.rand(3) ? UNSET : rng.rand(5)));
+					Glyph glyph(oper, (events && c == 'b') ? event : LuaValue());
+					temp.define_glyph(c, glyph);
+					reference.legend[c] = glyph;
+				}
+
+				for (int orient = ORIENT_DEFAULT; orient <= ORIENT_TURN_270; orient++) {
+					Map base(Size(12, 12));
+					FOR_EACH_BBOX(BBox(Pos(), base.size()), x, y) {
+						base[Pos(x, y)] = Square(rng.rand(8), rng.rand(3));
+					}
+					Pos xy(rng.rand(-2, 10), rng.rand(-2, 10));
+					MapPtr expected(new Map(base)), actual(new Map(base));
+					bool matched = reference.matches(expected, xy, (Orientation)orient);
+					CHECK(temp.matches(actual, ROOT_GROUP_ID, xy, (Orientation)orient) == matched);
+
+					bool turned = (orient == ORIENT_TURN_90 || orient == ORIENT_TURN_270);
+					BBox rect(xy, turned ? Size(size.h, size.w) : size);
+					if (rect.resized_within(BBox(Pos(), base.size())) != rect) {
+						continue;
+					}
+					expected->make_group(rect, ROOT_GROUP_ID);
+					reference.apply(expected, xy, (Orientation)orient);
+					std::string expected_log = take_log(L);
+					temp.apply(actual, ROOT_GROUP_ID, xy, (Orientation)orient, true);
+					CHECK(same_map(*expected, *actual));
+					CHECK(take_log(L) == expected_log);
+				}
+			}
+			CHECK_EQUAL(0, lua_gettop(L));
+			event.clear();
+		}
+		L.finish_check();
+	}
+}
@@ -0,0 +1,154 @@
+#include <vector>
+
+#include <lcommon/unittest.h>
+
+#include "collision_avoidance/CollisionAvoidance.h"
+#include "gamestate/GameInstSet.h"
+#include "gamestate/GameTiles.h"
+#include "objects/GameInst.h"
+#include "util/worker_pool.h"
+
+const int CROWD_SIZE = 400, CROWD_STEPS = 30, CROWD_AREA = 2048;
+
+// Steps a crowd converging on the centre, returning the GameInstSet hash
+static unsigned int simulate_crowd(int n_threads) {
+	worker_pool().set_threads(n_threads);
+
+	CollisionAvoidance avoidance;
+	GameInstSet insts(CROWD_AREA, CROWD_AREA);
+	std::vector<GameInst*> crowd;
+	std::vector<simul_id> ids;
+	for (int i = 0; i < CROWD_SIZE; i++) {
+		PosF xy(64 + (i % 20) * 90 + (i * 7) % 13, 64 + (i / 20) * 90 + (i * 11) % 17);
+		GameInst* inst = new GameInst(xy.x, xy.y, 10);
+		insts.add_instance(inst);
+		crowd.push_back(inst);
+		ids.push_back(avoidance.add_active_object(xy, 10, 4));
+	}
+
+	for (int step = 0; step < CROWD_STEPS; step++) {
+		for (int i = 0; i < CROWD_SIZE; i++) {
+			PosF xy = avoidance.get_position(ids[i]);
+			float dx = CROWD_AREA / 2 - xy.x, dy = CROWD_AREA / 2 - xy.y;
+			float dist = sqrt(dx * dx + dy * dy);
+			if (dist > 4) {
+				avoidance.set_preferred_velocity(ids[i], dx * 4 / dist, dy * 4 / dist);
+			} else {
+				avoidance.set_preferred_velocity(ids[i], 0, 0);
+			}
+		}
+		avoidance.step();
+		for (int i = 0; i < CROWD_SIZE; i++) {
+			PosF xy = avoidance.get_position(ids[i]);
+			crowd[i]->update_position(xy.x, xy.y);
+		}
+	}
+	return insts.hash();
+}
+
+// Removes two thirds of a crowd part way, optionally compacting afterwards,
+// and returns the positions of the survivors
+static std::vector<PosF> simulate_thinned_crowd(bool compact) {
+	CollisionAvoidance avoidance;
+	std::vector<simul_id> ids;
+	for (int i = 0; i < CROWD_SIZE; i++) {
+		PosF xy(64 + (i % 20) * 90, 64 + (i / 20) * 90);
+		ids.push_back(avoidance.add_active_object(xy, 10, 4));
+	}
+	for (int step = 0; step < CROWD_STEPS; step++) {
+		if (step == CROWD_STEPS / 3) {
+			std::vector<simul_id> survivors;
+			for (int i = 0; i < ids.size(); i++) {
+				if (i % 3 == 0) {
+					survivors.push_back(ids[i]);
+				} else {
+					avoidance.remove_object(ids[i]);
+				}
+			}
+			ids.swap(survivors);
+			if (compact) {
+				CHECK(avoidance.wants_compaction());
+				std::vector<simul_id> remap;
+				avoidance.compact(remap);
+				for (int i = 0; i < ids.size(); i++) {
+					ids[i] = remap[ids[i]];
+					CHECK_EQUAL(i, ids[i]);
+				}
+			}
+		}
+		for (int i = 0; i < ids.size(); i++) {
+			PosF xy = avoidance.get_position(ids[i]);
+			float dx = CROWD_AREA / 2 - xy.x, dy = CROWD_AREA / 2 - xy.y;
+			float dist = sqrt(dx * dx + dy * dy);
+			if (dist > 4) {
+				avoidance.set_preferred_velocity(ids[i], dx * 4 / dist, dy * 4 / dist);
+			}
+		}
+		avoidance.step();
+	}
+	std::vector<PosF> positions;
+	for (int i = 0; i < ids.size(); i++) {
+		positions.push_back(avoidance.get_position(ids[i]));
+	}
+	return positions;
+}
+
+SUITE(CollisionAvoidance_tests) {
+	TEST(parallel_step_is_deterministic) {
+		int original_threads = worker_pool().threads();
+		unsigned int serial_hash = simulate_crowd(0);
+		for (int n_threads = 1; n_threads <= 4; n_threads++) {
+			CHECK_EQUAL(serial_hash, simulate_crowd(n_threads));
+		}
+		worker_pool().set_threads(original_threads);
+	}
+
+	TEST(compaction_keeps_results) {
+		std::vector<PosF> expected = simulate_thinned_crowd(false);
+		std::vector<PosF> compacted = simulate_thinned_crowd(true);
+		CHECK_EQUAL(expected.size(), compacted.size());
+		for (int i = 0; i < expected.size() && i < compacted.size(); i++) {
+			CHECK(expected[i] == compacted[i]);
+		}
+	}
+
+	TEST(walls_block_steering) {
+		// A horizontal corridor one tile high, the rest solid
+		GameTiles tiles(Size(8, 5));
+		for (int x = 1; x < 7; x++) {
+			tiles.set_solid(Pos(x, 2), false);
+		}
+		CollisionAvoidance avoidance;
+		avoidance.update_walls(tiles);
+		simul_id id = avoidance.add_active_object(PosF(48, 80), 10, 4);
+		for (int step = 0; step < 20; step++) {
+			// Head diagonally into the corridor's bottom wall
+			avoidance.set_preferred_velocity(id, 2, 3);
+			avoidance.step();
+		}
+		PosF xy = avoidance.get_position(id);
+		CHECK(xy.x > 48);
+		CHECK(xy.y + 10 <= 3 * TILE_SIZE + 0.5f);
+
+		// Opening the wall below lets the object through
+		tiles.set_solid(Pos(4, 3), false);
+		tiles.set_solid(Pos(4, 4), false);
+		avoidance.update_walls(tiles);
+		avoidance.set_position(id, 4 * TILE_SIZE + 16, 80);
+		for (int step = 0; step < 10; step++) {
+			avoidance.set_preferred_velocity(id, 0, 3);
+			avoidance.step();
+		}
+		CHECK(avoidance.get_position(id).y > 3 * TILE_SIZE);
+	}
+
+	TEST(removed_ids_are_reused) {
+		CollisionAvoidance avoidance;
+		simul_id first = avoidance.add_passive_object(PosF(0, 0), 10);
+		simul_id second = avoidance.add_passive_object(PosF(100, 0), 10);
+		avoidance.remove_object(first);
+		CHECK_EQUAL(first, avoidance.add_passive_object(PosF(200, 0), 10));
+		CHECK(avoidance.get_position(second) == PosF(100, 0));
+		CHECK(!avoidance.wants_compaction());
+	}
+}
@@ -0,0 +1,75 @@
+#include <lcommon/unittest.h>
+#include <lcommon/SerializeBuffer.h>
+
+#include <luawrap/luawrap.h>
+#include <luawrap/testutils.h>
+
+#include "stats/effects.h"
+
+SUITE(EffectArray_tests) {
+
+	static Effect active_effect(lua_State* L, effect_id id) {
+		Effect eff;
+		eff.id = id;
+		eff.state = LuaValue::newtable(L);
+		eff.state["active"] = true;
+		return eff;
+	}
+
+	TEST(all_active_grows_past_capacity) {
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			EffectArray effects;
+			for (int i = 0; i < EFFECTS_MAX; i++) {
+				effects.push_back(active_effect(L, i));
+			}
+			// No entry is free, so no active effect is overwritten
+			Effect& added = effects.new_entry();
+			added = active_effect(L, EFFECTS_MAX);
+			CHECK_EQUAL(EFFECTS_MAX + 1, effects.size());
+			for (int i = 0; i <= EFFECTS_MAX; i++) {
+				CHECK_EQUAL(i, effects[i].id);
+				CHECK(effects[i].is_active());
+			}
+
+			// Once one expires, its entry is reused first
+			effects[3].state["active"] = false;
+			CHECK(&effects.new_entry() == &effects[3]);
+			CHECK_EQUAL(EFFECTS_MAX + 1, effects.size());
+			CHECK(effects[3].state.empty());
+			effects.clear();
+		}
+		L.finish_check();
+	}
+
+	TEST(long_stream_keeps_alignment) {
+		// As EffectStats::serialize wrote effects once there were more than EFFECTS_MAX
+		const int N_EFFECTS = EFFECTS_MAX + 7;
+		EffectArray written, read;
+		for (int i = 0; i < N_EFFECTS; i++) {
+			Effect eff;
+			eff.id = i;
+			written.push_back(eff);
+		}
+		SerializeBuffer serializer;
+		serializer.write_container(written, [&](const Effect& eff) {
+			serializer.write_int(eff.id);
+		});
+		serializer.write_int(1234);
+
+		serializer.read_container(read, [&](Effect& eff) {
+			serializer.read_int(eff.id);
+		});
+		CHECK_EQUAL(N_EFFECTS, read.size());
+		for (int i = 0; i < N_EFFECTS; i++) {
+			CHECK_EQUAL(i, read[i].id);
+		}
+		// The data after the effects is read where it was written
+		CHECK_EQUAL(1234, serializer.read_int());
+
+		// Shrinking releases the spilled entries
+		read.resize(2);
+		CHECK_EQUAL(2, read.size());
+		CHECK_EQUAL(1, read.back().id);
+	}
+}
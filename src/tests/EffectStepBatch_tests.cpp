@@ -0,0 +1,97 @@
+#include <lcommon/unittest.h>
+
+#include <luawrap/luawrap.h>
+#include <luawrap/testutils.h>
+
+#include "gamestate/EffectStepBatch.h"
+#include "objects/GameInst.h"
+#include "stats/effect_data.h"
+#include "stats/effects.h"
+
+namespace lua_api {
+	void register_lua_core_GameObject(lua_State* L);
+}
+
+static const char* BATCH_CODE = "log = ''\n"
+		"T = {}\n"
+		"T.__index = T\n"
+		"function poison_batch(states, objects)\n"
+		"    local names = {}\n"
+		"    for i, obj in ipairs(objects) do names[i] = obj.name end\n"
+		"    log = log .. 'poison ' .. table.concat(names, ',') .. ';'\n"
+		"end\n"
+		"a = setmetatable({name = 'a', __objectref = true}, T)\n"
+		"b = setmetatable({name = 'b', __objectref = true}, T)\n"
+		"c = setmetatable({name = 'c', __objectref = true}, T)\n";
+
+SUITE(EffectStepBatch_tests) {
+	// Pins when batched effects step relative to their owners, see EffectStepBatch.h
+	TEST (test_batched_after_all_owners) {
+		const char* NAMES[] = { "a", "b", "c" };
+		GameInst* insts[3];
+		for (int i = 0; i < 3; i++) {
+			insts[i] = new GameInst(0, 0, 10);
+		}
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			luaL_openlibs(L);
+			// Objects are passed to Lua through the GameInst* type
+			lua_api::register_lua_core_GameObject(L);
+			lua_assert_valid_dostring(L, BATCH_CODE);
+			LuaValue globals = luawrap::globals(L);
+
+			EffectEntry poison, regen;
+			poison.name = "EffectStepBatch_test_poison";
+			poison.step_batch_func = globals["poison_batch"];
+			regen.name = "EffectStepBatch_test_regen";
+			effect_id poison_id = game_effect_data.size();
+			game_effect_data.new_entry(poison.name, poison);
+			effect_id regen_id = game_effect_data.size();
+			game_effect_data.new_entry(regen.name, regen);
+
+			Effect effects[3][2];
+			for (int i = 0; i < 3; i++) {
+				insts[i]->lua_variables = globals[NAMES[i]];
+				effects[i][0].id = regen_id;
+				effects[i][1].id = poison_id;
+				for (Effect& eff : effects[i]) {
+					eff.state = LuaValue::newtable(L);
+				}
+			}
+
+			// As EffectStats::step within GameInstSet::step, 'b' is removed by a later instance
+			std::string steps;
+			EffectStepBatch batch;
+			batch.begin();
+			for (int i = 0; i < 3; i++) {
+				steps += std::string("step ") + NAMES[i] + ";";
+				for (Effect& eff : effects[i]) {
+					if (!batch.add(insts[i], eff)) {
+						steps += std::string("regen ") + NAMES[i] + ";";
+					}
+				}
+			}
+			insts[1]->destroyed = true;
+			CHECK_EQUAL("", globals["log"].to_str());
+			batch.dispatch(L);
+			CHECK(steps == "step a;regen a;step b;regen b;step c;regen c;");
+			CHECK_EQUAL("poison a,c;", globals["log"].to_str());
+			CHECK_EQUAL(0, lua_gettop(L));
+
+			// Outside of a level's step, effects step with their owner
+			CHECK(!batch.add(insts[0], effects[0][1]));
+
+			// Release the references before the state closes
+			batch.clear();
+			game_effect_data.get(poison_id).step_batch_func.clear();
+			for (int i = 0; i < 3; i++) {
+				for (Effect& eff : effects[i]) {
+					eff.state.clear();
+				}
+				insts[i]->lua_variables.clear();
+				delete insts[i];
+			}
+		}
+		L.finish_check();
+	}
+}
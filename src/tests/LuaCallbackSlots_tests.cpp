@@ -0,0 +1,149 @@
+#include <lcommon/unittest.h>
+
+#include <luawrap/luawrap.h>
+
+#include "objects/LuaCallbackSlots.h"
+
+static const char* TYPES_CODE = "do_nothing = function() end\n"
+		"calls = 0\n"
+		"T = {}\n"
+		"T.on_step = function() calls = calls + 1 end\n"
+		"T.on_draw = do_nothing\n"
+		"T.__index = T\n"
+		"a = setmetatable({}, T)\n"
+		"b = setmetatable({on_step = function() calls = calls + 10 end}, T)\n"
+		"c = {type = {on_deinit = function() calls = calls + 100 end}}\n";
+
+static int try_call(LuaValue& object, LuaCallbackCache& cache,
+		lua_callback_t callback) {
+	lua_State* L = object.luastate();
+	if (!lua_callbacks_push(object, cache, callback)) {
+		return 0;
+	}
+	lua_call(L, 0, 0);
+	return 1;
+}
+
+SUITE(LuaCallbackSlots_tests) {
+	TEST (test_resolve_per_type) {
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			luaL_openlibs(L);
+			lua_assert_valid_dostring(L, TYPES_CODE);
+			LuaValue globals = luawrap::globals(L);
+			LuaValue a = globals["a"], b = globals["b"], c = globals["c"];
+			LuaCallbackCache cache_a, cache_b, cache_c;
+
+			CHECK_EQUAL(1, try_call(a, cache_a, CALLBACK_ON_STEP));
+			CHECK_EQUAL(1, try_call(b, cache_b, CALLBACK_ON_STEP));
+			// 'do_nothing' and missing hooks are cached as absent
+			CHECK_EQUAL(0, try_call(a, cache_a, CALLBACK_ON_DRAW));
+			CHECK_EQUAL(0, try_call(a, cache_a, CALLBACK_ON_DEINIT));
+			// Falls back to the 'type' field
+			CHECK_EQUAL(1, try_call(c, cache_c, CALLBACK_ON_DEINIT));
+			CHECK_EQUAL(111, globals["calls"].to_int());
+
+			// Instances of one type share their slots
+			CHECK(cache_a.slots == cache_b.slots);
+
+			// Replacing a hook the type holds needs explicit invalidation
+			lua_assert_valid_dostring(L,
+					"T.on_step = function() calls = calls + 1000 end");
+			globals["T"].push();
+			lua_callbacks_invalidate(L, -1);
+			lua_pop(L, 1);
+			CHECK(cache_a.slots->stale);
+			CHECK(!cache_c.slots->stale);
+			CHECK_EQUAL(1, try_call(a, cache_a, CALLBACK_ON_STEP));
+			CHECK_EQUAL(1111, globals["calls"].to_int());
+			CHECK_EQUAL(0, lua_gettop(L));
+		}
+		L.finish_check();
+	}
+
+	TEST (test_new_type_hook) {
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			luaL_openlibs(L);
+			lua_assert_valid_dostring(L, TYPES_CODE);
+			LuaValue globals = luawrap::globals(L);
+			LuaValue a = globals["a"], c = globals["c"];
+			LuaCallbackCache cache_a, cache_c;
+
+			CHECK_EQUAL(0, try_call(a, cache_a, CALLBACK_ON_POST_DRAW));
+			CHECK_EQUAL(0, try_call(c, cache_c, CALLBACK_ON_DRAW));
+
+			// Hooks added to a type are seen through its __newindex
+			lua_assert_valid_dostring(L,
+					"T.on_post_draw = function() calls = calls + 1 end\n"
+					"c.type.on_draw = function() calls = calls + 10 end\n"
+					"T.not_a_hook = 1");
+			CHECK_EQUAL(1, try_call(a, cache_a, CALLBACK_ON_POST_DRAW));
+			CHECK_EQUAL(1, try_call(c, cache_c, CALLBACK_ON_DRAW));
+			CHECK_EQUAL(11, globals["calls"].to_int());
+			CHECK_EQUAL(1, globals["T"]["not_a_hook"].to_int());
+			CHECK_EQUAL(0, lua_gettop(L));
+		}
+		L.finish_check();
+	}
+
+	// Only type tables without a metatable get the watcher
+	TEST (test_existing_metatable_kept) {
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			luaL_openlibs(L);
+			lua_assert_valid_dostring(L, TYPES_CODE);
+			lua_assert_valid_dostring(L,
+					"Base = {}\n"
+					"Base.__index = Base\n"
+					"Sub = setmetatable({}, Base)\n"
+					"Sub.__index = Sub\n"
+					"d = setmetatable({}, Sub)\n");
+			LuaValue globals = luawrap::globals(L);
+			LuaValue d = globals["d"];
+			LuaCallbackCache cache_d;
+			CHECK_EQUAL(0, try_call(d, cache_d, CALLBACK_ON_STEP));
+
+			lua_callbacks_push_watcher(L);
+			globals["watcher"].pop();
+			lua_assert_valid_dostring(L,
+					"assert(getmetatable(Sub) == Base)\n"
+					"assert(getmetatable(Base) == watcher)\n"
+					"assert(rawget(Base, '__newindex') == nil)");
+
+			// New hooks in the base type are seen, the subtype needs invalidation
+			lua_assert_valid_dostring(L,
+					"Base.on_step = function() calls = calls + 1 end");
+			CHECK_EQUAL(1, try_call(d, cache_d, CALLBACK_ON_STEP));
+			lua_assert_valid_dostring(L,
+					"Sub.on_step = function() calls = calls + 10 end");
+			CHECK(!cache_d.slots->stale);
+			globals["Sub"].push();
+			lua_callbacks_invalidate(L, -1);
+			lua_pop(L, 1);
+			CHECK_EQUAL(1, try_call(d, cache_d, CALLBACK_ON_STEP));
+			CHECK_EQUAL(11, globals["calls"].to_int());
+			CHECK_EQUAL(0, lua_gettop(L));
+		}
+		L.finish_check();
+	}
+
+	// The slots belong to the state, a later state never sees its hooks
+	TEST (test_slots_per_state) {
+		for (int i = 0; i < 3; i++) {
+			TestLuaState L;
+			/* Ensure clean-up order with explicit block */ {
+				luaL_openlibs(L);
+				lua_assert_valid_dostring(L, TYPES_CODE);
+				LuaValue globals = luawrap::globals(L);
+				LuaValue a = globals["a"];
+				LuaCallbackCache cache_a;
+
+				CHECK_EQUAL(1, try_call(a, cache_a, CALLBACK_ON_STEP));
+				CHECK_EQUAL(0, try_call(a, cache_a, CALLBACK_ON_DRAW));
+				CHECK_EQUAL(1, globals["calls"].to_int());
+			}
+			L.finish_check();
+		}
+	}
+}
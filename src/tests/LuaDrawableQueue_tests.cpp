@@ -30,4 +30,27 @@ SUITE(LuaDrawableQueue_tests) {
 		}
 
 	}
+
+	TEST (test_entries_and_clear) {
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			LuaDrawableQueue queue;
+			LuaValue value(L);
+
+			/* Entries are kept in order of addition, with their depth */
+			for (int i = 0; i < 3; i++) {
+				lua_pushnumber(L, i);
+				value.pop();
+				queue.add(value, 10 - i, PosF());
+			}
+			CHECK_EQUAL(3, queue.size());
+			for (int i = 0; i < 3; i++) {
+				CHECK_EQUAL(10 - i, queue.entry_depth(i));
+			}
+
+			queue.clear();
+			CHECK_EQUAL(0, queue.size());
+			CHECK(queue.get_iterator().is_done());
+		}
+	}
 }
@@ -0,0 +1,66 @@
+#include <lcommon/unittest.h>
+
+#include <luawrap/luawrap.h>
+
+#include "gamestate/LuaStepBatch.h"
+#include "objects/GameInst.h"
+
+static const char* BATCH_CODE = "do_nothing = function() end\n"
+		"log = ''\n"
+		"T = {}\n"
+		"T.__index = T\n"
+		"function T:on_step() log = log .. 'step ' .. self.name .. ';' end\n"
+		"function T.on_step_batch(objects)\n"
+		"    local names = {}\n"
+		"    for i, obj in ipairs(objects) do names[i] = obj.name end\n"
+		"    log = log .. 'batch ' .. table.concat(names, ',') .. ';'\n"
+		"end\n"
+		"a = setmetatable({name = 'a'}, T)\n"
+		"b = setmetatable({name = 'b'}, T)\n"
+		"c = setmetatable({name = 'c'}, T)\n";
+
+SUITE(LuaStepBatch_tests) {
+	TEST (test_step_then_batch) {
+		const char* NAMES[] = { "a", "b", "c" };
+		GameInst* insts[3];
+		for (int i = 0; i < 3; i++) {
+			insts[i] = new GameInst(0, 0, 10);
+		}
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			luaL_openlibs(L);
+			lua_assert_valid_dostring(L, BATCH_CODE);
+			LuaValue globals = luawrap::globals(L);
+			for (int i = 0; i < 3; i++) {
+				insts[i]->lua_variables = globals[NAMES[i]];
+			}
+
+			// As in GameInstSet::step, 'b' is removed by a later instance
+			LuaStepBatch batch;
+			batch.begin();
+			for (int i = 0; i < 3; i++) {
+				insts[i]->step_lua(&batch);
+			}
+			insts[1]->destroyed = true;
+			batch.dispatch(L);
+			CHECK_EQUAL("step a;step b;step c;batch a,c;",
+					globals["log"].to_str());
+
+			// The reused array does not keep entries of the larger frame
+			lua_assert_valid_dostring(L, "log = ''");
+			batch.begin();
+			insts[2]->step_lua(&batch);
+			batch.dispatch(L);
+			CHECK_EQUAL("step c;batch c;", globals["log"].to_str());
+			CHECK_EQUAL(0, lua_gettop(L));
+
+			// Release the references before the state closes
+			batch.clear();
+			for (int i = 0; i < 3; i++) {
+				insts[i]->lua_variables.clear();
+				delete insts[i];
+			}
+		}
+		L.finish_check();
+	}
+}
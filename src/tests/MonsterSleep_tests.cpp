@@ -0,0 +1,59 @@
+#include <vector>
+#include <algorithm>
+
+#include <lcommon/unittest.h>
+
+#include "gamestate/GameInstSet.h"
+#include "gamestate/GameMapState.h"
+#include "objects/GameInst.h"
+#include "objects/MonsterController.h"
+
+SUITE(MonsterSleep_tests) {
+
+	TEST(wake_query) {
+		GameInstSet insts(2048, 2048);
+		GameInst* waker = new GameInst(500, 500, 10);
+		GameInst* near = new GameInst(580, 500, 10);
+		GameInst* diagonal = new GameInst(580, 420, 10);
+		GameInst* touching = new GameInst(605, 500, 10);
+		GameInst* far = new GameInst(700, 500, 10);
+		insts.add_instance(waker);
+		insts.add_instance(near);
+		insts.add_instance(diagonal);
+		insts.add_instance(touching);
+		insts.add_instance(far);
+
+		std::vector<GameInst*> wakers(1, waker);
+		std::vector<obj_id> ids;
+		monster_wake_query(insts, wakers, 100, ids);
+
+		std::vector<obj_id> expected;
+		expected.push_back(near->id);
+		expected.push_back(diagonal->id);
+		expected.push_back(touching->id);
+		std::sort(expected.begin(), expected.end());
+		CHECK(ids == expected);
+
+		// The waker coming within range wakes the far one
+		waker->update_position(620, 500);
+		monster_wake_query(insts, wakers, 100, ids);
+		CHECK(std::binary_search(ids.begin(), ids.end(), far->id));
+	}
+
+	TEST(unwatched_levels_step_less_often) {
+		const int FRAMES = 16;
+		for (level_id id = 0; id < 4; id++) {
+			int watched_steps = 0, unwatched_steps = 0;
+			for (int frame = 0; frame < FRAMES; frame++) {
+				watched_steps += GameMapState::steps_on_frame(frame, id, true);
+				unwatched_steps += GameMapState::steps_on_frame(frame, id, false);
+			}
+			CHECK_EQUAL(FRAMES, watched_steps);
+			CHECK_EQUAL(FRAMES / 4, unwatched_steps);
+		}
+		// Staggered, so levels do not all step on the same frame
+		CHECK(GameMapState::steps_on_frame(0, 0, false));
+		CHECK(!GameMapState::steps_on_frame(0, 1, false));
+		CHECK(GameMapState::steps_on_frame(3, 1, false));
+	}
+}
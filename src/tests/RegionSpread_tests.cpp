@@ -0,0 +1,109 @@
+#include <lua.hpp>
+
+#include <lcommon/unittest.h>
+#include <lcommon/lua_lcommon.h>
+
+#include <luawrap/LuaValue.h>
+#include <luawrap/luawrap.h>
+#include <luawrap/testutils.h>
+
+#include <ldungeon_gen/lua_ldungeon.h>
+
+#include <lua_api/lua_api.h>
+
+extern "C" {
+int luaopen_lpeg(lua_State* L);
+}
+
+namespace lua_api {
+	void register_lua_core_RVOWorld(lua_State* L);
+}
+
+// Loads the MoonScript map utilities from the runtime directory, where
+// 'lanarts --tests' runs. MapRegion's Box2D and debug display helpers are not
+// needed for spreading, so they are left out.
+static const char* LUA_SETUP_CODE =
+		"require 'globals.CoreGlobals'\n"
+		"require 'globals.Math'\n"
+		"require('moonscript.base').insert_loader()\n"
+		"package.loaded['maps.B2GenerateUtils'] = {}\n"
+		"package.loaded['maps.DebugUtils'] = {}\n"
+		"GenerateUtils = require 'maps.GenerateUtils'\n"
+		"MapRegion = require('maps.MapRegion').MapRegion\n";
+
+// Runs the GenerateUtils.RVORegionPlacer loop over MapRegionAdapters, as
+// MapCompiler did for 'rvo_spread' and 'rvo_center', against region_spread
+static const char* LUA_SPREAD_CODE =
+		"function make_regions(boxes)\n"
+		"    local regions = {}\n"
+		"    for i, b in ipairs(boxes) do\n"
+		"        local x1, y1, x2, y2 = b[1], b[2], b[3], b[4]\n"
+		"        regions[i] = MapRegion.create {{{x1, y1}, {x2, y1}, {x2, y2}, {x1, y2}}}\n"
+		"    end\n"
+		"    return regions\n"
+		"end\n"
+		"function placer_spread(rng, regions, mode, iters)\n"
+		"    local velocity_func = GenerateUtils.spread_region_delta_func\n"
+		"    if mode == 'center' then velocity_func = GenerateUtils.center_region_delta_func end\n"
+		"    local spreader, adapters = GenerateUtils.RVORegionPlacer.create(), {}\n"
+		"    for i, r in ipairs(regions) do\n"
+		"        adapters[i] = GenerateUtils.MapRegionAdapter.create(r)\n"
+		"        spreader:add(adapters[i], velocity_func(nil, rng, {center = function() return 0, 0 end}))\n"
+		"    end\n"
+		"    for i = 1, iters do spreader:step() end\n"
+		"    local translations = {}\n"
+		"    for i, a in ipairs(adapters) do translations[i] = {a.x - a.ox, a.y - a.oy} end\n"
+		"    return translations\n"
+		"end\n"
+		"function native_spread(rng, regions, mode, iters)\n"
+		"    return (require 'core.SourceMap').region_spread {rng = rng, regions = regions, mode = mode, iterations = iters}\n"
+		"end\n"
+		"function compare_spread(mode, iters)\n"
+		"    local box_rng, boxes = require('mtwist').create(7), {}\n"
+		"    for i = 1, 24 do\n"
+		"        local x, y = box_rng:random(-20, 20), box_rng:random(-20, 20)\n"
+		"        boxes[i] = {x, y, x + box_rng:random(4, 16), y + box_rng:random(4, 16)}\n"
+		"    end\n"
+		"    local rng1, rng2 = require('mtwist').create(1234), require('mtwist').create(1234)\n"
+		"    local expected = placer_spread(rng1, make_regions(boxes), mode, iters)\n"
+		"    local translations = native_spread(rng2, make_regions(boxes), mode, iters)\n"
+		"    assert(rng1:amount_generated() == rng2:amount_generated(), 'rng use differs')\n"
+		"    local moved = false\n"
+		"    for i = 1, #boxes do\n"
+		"        assert(translations[i][1] == expected[i][1] and translations[i][2] == expected[i][2],\n"
+		"            'region ' .. i .. ' placed differently')\n"
+		"        moved = moved or expected[i][1] ~= 0\n"
+		"    end\n"
+		"    assert(moved, 'nothing moved')\n"
+		"end\n";
+
+static void register_spread_apis(lua_State* L) {
+	luaL_openlibs(L);
+	luaopen_lpeg(L);
+	lua_pop(L, 1);
+	lua_register_lcommon(L);
+	lua_api::register_general_api(L);
+	lua_settop(L, 0);
+	LuaValue map_gen = lua_api::register_lua_submodule(L, "core.SourceMap");
+	ldungeon_gen::lua_register_ldungeon(map_gen, false);
+	lua_api::register_lua_core_RVOWorld(L);
+	lua_api::add_search_path(L, "dependencies/?.lua");
+	lua_assert_valid_dostring(L, LUA_SETUP_CODE);
+	lua_assert_valid_dostring(L, LUA_SPREAD_CODE);
+}
+
+SUITE(RegionSpread_tests) {
+	TEST(native_matches_lua_spread) {
+		TestLuaState L;
+		register_spread_apis(L);
+		lua_assert_valid_dostring(L, "compare_spread('spread', 200)");
+		L.finish_check();
+	}
+
+	TEST(native_matches_lua_center) {
+		TestLuaState L;
+		register_spread_apis(L);
+		lua_assert_valid_dostring(L, "compare_spread('center', 200)");
+		L.finish_check();
+	}
+}
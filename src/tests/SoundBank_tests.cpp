@@ -0,0 +1,144 @@
+#include <cstdio>
+
+#include <SDL_timer.h>
+
+#include <lcommon/unittest.h>
+
+#include <lsound/SoundBank.h>
+
+using namespace lsound;
+
+SUITE(SoundBank_tests) {
+
+	static unsigned test_time = 0;
+
+	static unsigned test_clock() {
+		return test_time;
+	}
+
+	// The null backend 'decodes' a file to its size in bytes
+	static void write_file(const char* filename, int bytes) {
+		FILE* file = fopen(filename, "wb");
+		for (int i = 0; i < bytes; i++) {
+			fputc('0', file);
+		}
+		fclose(file);
+	}
+
+	static void wait_for_decodes(SoundBank& bank, int decodes) {
+		for (int i = 0; i < 2000 && bank.stats().decodes < decodes; i++) {
+			SDL_Delay(1);
+			bank.update();
+		}
+	}
+
+	TEST(voices_start_on_main_thread) {
+		write_file("SoundBank_test_a.tmp", 10);
+		SoundBank bank(test_clock);
+		// Added before init, so that decoding only starts on play
+		int a = bank.add("SoundBank_test_a.tmp", 0);
+		AudioBackend* backend = new_null_backend(2);
+		bank.init(backend);
+
+		bank.play(a, false);
+		SDL_Delay(50);
+		CHECK(!backend->is_playing(0));
+		wait_for_decodes(bank, 1);
+		CHECK(backend->is_playing(0));
+		CHECK_EQUAL(0, bank.stats().dropped);
+
+		bank.deinit();
+		remove("SoundBank_test_a.tmp");
+	}
+
+	TEST(late_pending_play_dropped) {
+		write_file("SoundBank_test_a.tmp", 10);
+		test_time = 1000;
+		SoundBank bank(test_clock);
+		int a = bank.add("SoundBank_test_a.tmp", 0);
+		AudioBackend* backend = new_null_backend(2);
+		bank.init(backend);
+
+		bank.play(a, false);
+		test_time += SoundBank::PENDING_PLAY_WINDOW + 1;
+		wait_for_decodes(bank, 1);
+		CHECK(!backend->is_playing(0));
+		CHECK_EQUAL(1, bank.stats().dropped);
+
+		// Once decoded, plays start immediately
+		bank.play(a, false);
+		CHECK(backend->is_playing(0));
+
+		bank.deinit();
+		remove("SoundBank_test_a.tmp");
+	}
+
+	TEST(priority_steals_voice) {
+		write_file("SoundBank_test_a.tmp", 10);
+		write_file("SoundBank_test_b.tmp", 10);
+		SoundBank bank(test_clock);
+		int low = bank.add("SoundBank_test_a.tmp", 0);
+		int high = bank.add("SoundBank_test_b.tmp", 1);
+		AudioBackend* backend = new_null_backend(1);
+		bank.init(backend);
+
+		bank.play(low, false);
+		wait_for_decodes(bank, 1);
+		bank.play(high, false);
+		wait_for_decodes(bank, 2);
+		CHECK(backend->is_playing(0));
+		CHECK_EQUAL(1, bank.stats().steals);
+
+		// Lower priority sounds never steal from higher ones
+		bank.play(low, false);
+		CHECK_EQUAL(1, bank.stats().steals);
+		CHECK_EQUAL(1, bank.stats().dropped);
+
+		bank.deinit();
+		remove("SoundBank_test_a.tmp");
+		remove("SoundBank_test_b.tmp");
+	}
+
+	TEST(instances_limited) {
+		write_file("SoundBank_test_a.tmp", 10);
+		SoundBank bank(test_clock);
+		int a = bank.add("SoundBank_test_a.tmp", 0);
+		AudioBackend* backend = new_null_backend(2);
+		bank.init(backend);
+		bank.set_max_instances(1);
+
+		bank.play(a, false);
+		wait_for_decodes(bank, 1);
+		bank.play(a, false);
+		CHECK(backend->is_playing(0));
+		CHECK(!backend->is_playing(1));
+		CHECK_EQUAL(1, bank.stats().steals);
+
+		bank.deinit();
+		remove("SoundBank_test_a.tmp");
+	}
+
+	TEST(evicts_least_recently_played) {
+		write_file("SoundBank_test_a.tmp", 10);
+		write_file("SoundBank_test_b.tmp", 20);
+		SoundBank bank(test_clock);
+		int a = bank.add("SoundBank_test_a.tmp", 0);
+		int b = bank.add("SoundBank_test_b.tmp", 0);
+		AudioBackend* backend = new_null_backend(2);
+		bank.init(backend);
+		bank.set_memory_budget(25);
+
+		bank.play(a, false);
+		wait_for_decodes(bank, 1);
+		// Playing samples are never evicted
+		bank.stop_all();
+		bank.play(b, false);
+		wait_for_decodes(bank, 2);
+		CHECK_EQUAL(1, bank.stats().evictions);
+		CHECK_EQUAL(20, (int)bank.stats().bytes_loaded);
+
+		bank.deinit();
+		remove("SoundBank_test_a.tmp");
+		remove("SoundBank_test_b.tmp");
+	}
+}
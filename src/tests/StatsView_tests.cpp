@@ -0,0 +1,55 @@
+#include <lua.hpp>
+
+#include <lcommon/unittest.h>
+
+#include <luawrap/luawrap.h>
+#include <luawrap/testutils.h>
+
+#include "lua_api/lua_api.h"
+#include "stats/combat_stats.h"
+
+SUITE(StatsView_tests) {
+
+	TEST(combatstats_view_fields) {
+		CombatStats stats;
+		stats.class_stats.xpneeded = 100;
+		stats.core.hp = 10;
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			LuaValue globals = luawrap::globals(L);
+			lua_combatstats_bindings(NULL, L);
+			globals["assert"].bind_function(unit_test_assert);
+
+			lua_push_combatstats(L, stats);
+			globals["stats"].pop();
+			// 'xpneeded' can only be written, reading it falls through to the methods
+			lua_assert_valid_dostring(L,
+					"assert('xp_needed reads', stats.xp_needed == 100)\n"
+					"assert('xpneeded reads as nil', stats.xpneeded == nil)\n"
+					"stats.xpneeded = 50\n"
+					"stats.hp = 5\n");
+			CHECK_EQUAL(50, stats.class_stats.xpneeded);
+			CHECK_EQUAL(5, stats.core.hp);
+
+			// Base stats given to stat_funcs: readable, but writes are ignored
+			const CombatStats& base = stats;
+			lua_push_combatstats(L, base);
+			globals["base"].pop();
+			lua_assert_valid_dostring(L,
+					"assert('read-only view reads', base.hp == 5)\n"
+					"base.hp = 1\n"
+					"base.xpneeded = 1\n"
+					"assert('read-only view unchanged', base.hp == 5)\n");
+			CHECK_EQUAL(5, stats.core.hp);
+			CHECK_EQUAL(50, stats.class_stats.xpneeded);
+
+			globals["stats"].push();
+			lua_release_combatstats(L, -1);
+			lua_pop(L, 1);
+			lua_assert_valid_dostring(L,
+					"assert('released view reads as nil', stats.hp == nil)\n");
+			lua_settop(L, 0);
+		}
+		L.finish_check();
+	}
+}
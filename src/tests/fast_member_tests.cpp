@@ -0,0 +1,55 @@
+#include <lua.hpp>
+
+#include <lcommon/unittest.h>
+
+#include <luawrap/luawrap.h>
+#include <luawrap/luameta.h>
+#include <luawrap/functions.h>
+#include <luawrap/members.h>
+#include <luawrap/types.h>
+#include <luawrap/testutils.h>
+
+struct FastPoint {
+	float x;
+	int id;
+};
+
+static LuaValue fastpoint_newmetatable(lua_State* L) {
+	LuaValue metatable = luameta_new(L, "FastPoint");
+	LuaValue getters = luameta_getters(metatable);
+	LuaValue setters = luameta_setters(metatable);
+	LUAWRAP_FAST_GETTER(getters["x"], FastPoint, x);
+	LUAWRAP_FAST_SETTER(setters["x"], FastPoint, x);
+	LUAWRAP_FAST_GETTER(getters["id"], FastPoint, id);
+	return metatable;
+}
+
+static FastPoint fastpoint_box(float x, int id) {
+	FastPoint p = { x, id };
+	return p;
+}
+
+SUITE(fast_member_tests) {
+
+	TEST(fast_member_access) {
+		TestLuaState L;
+		/* Ensure clean-up order with explicit block */ {
+			LuaValue globals = luawrap::globals(L);
+			luawrap::install_userdata_type<FastPoint, fastpoint_newmetatable>();
+			globals["assert"].bind_function(unit_test_assert);
+			globals["fastpoint_box"].bind_function(fastpoint_box);
+
+			lua_assert_valid_dostring(L,
+					"p = fastpoint_box(1.5, 2)\n"
+					"assert('fast getter for x', p.x == 1.5)\n"
+					"assert('fast getter for id', p.id == 2)\n"
+					"p.x = 3\n"
+					"assert('fast setter for x', p.x == 3)\n");
+			// Setter typechecks, and a getter alone does not allow writes
+			CHECK(luaL_dostring(L, "p.x = 'abc'") != 0);
+			CHECK(luaL_dostring(L, "p.id = 1") != 0);
+			lua_settop(L, 0);
+		}
+		L.finish_check();
+	}
+}
@@ -0,0 +1,35 @@
+#include <string>
+
+#include <lua.hpp>
+
+#include <luawrap/luawrap.h>
+
+#include <lcommon/luaserialize.h>
+#include <lcommon/unittest.h>
+#include <lcommon/SerializeBuffer.h>
+
+SUITE(lua_serialize_tests) {
+	TEST(lua_serialize_repeated_keys) {
+		TestLuaState L;
+
+		SerializeBuffer serializer;
+		// Push {{a_long_field_name = 1}, {a_long_field_name = 2}}
+		LuaValue repeated = LuaValue::newtable(L);
+		repeated[1] = LuaValue::newtable(L);
+		repeated[1]["a_long_field_name"] = 1;
+		repeated[2] = LuaValue::newtable(L);
+		repeated[2]["a_long_field_name"] = 2;
+		luaserialize_encode(L, serializer, repeated);
+
+		// The second use of the key should not repeat the string
+		std::string bytes(serializer.data(), serializer.size());
+		size_t first = bytes.find("a_long_field_name");
+		CHECK(first != std::string::npos);
+		CHECK(bytes.find("a_long_field_name", first + 1) == std::string::npos);
+
+		LuaValue result;
+		luaserialize_decode(L, serializer, result);
+		CHECK(result[1]["a_long_field_name"].to_int() == 1);
+		CHECK(result[2]["a_long_field_name"].to_int() == 2);
+	}
+}
@@ -0,0 +1,110 @@
+#include <vector>
+
+#include <lua.hpp>
+
+#include <lcommon/unittest.h>
+#include <lcommon/mtwist.h>
+#include <lcommon/lua_lcommon.h>
+
+#include <luawrap/luawrap.h>
+#include <luawrap/testutils.h>
+
+#include <ldungeon_gen/Map.h>
+#include <ldungeon_gen/map_misc_ops.h>
+#include <ldungeon_gen/lua_ldungeon.h>
+
+#include <lua_api/lua_api.h>
+
+using namespace ldungeon_gen;
+
+/* Size of the 4-connected region of squares matching 'selector' around 'seed' */
+static int flood_fill_size(Map& map, Pos seed, Selector selector) {
+	std::vector<bool> seen(map.width() * map.height());
+	std::vector<Pos> stack(1, seed);
+	seen[seed.y * map.width() + seed.x] = true;
+	int size = 0;
+	while (!stack.empty()) {
+		Pos xy = stack.back();
+		stack.pop_back();
+		size++;
+		const Pos next[] = {Pos(xy.x - 1, xy.y), Pos(xy.x + 1, xy.y), Pos(xy.x, xy.y - 1), Pos(xy.x, xy.y + 1)};
+		for (const Pos& n : next) {
+			if (n.x >= 0 && n.y >= 0 && n.x < map.width() && n.y < map.height()
+					&& !seen[n.y * map.width() + n.x] && map[n].matches(selector)) {
+				seen[n.y * map.width() + n.x] = true;
+				stack.push_back(n);
+			}
+		}
+	}
+	return size;
+}
+
+// Two rooms, as NewMaps checks and as fill_unconnected would fill them
+static const char* LUA_COMPONENTS_CODE =
+		"local SourceMap = require 'core.SourceMap'\n"
+		"local floor = {matches_none = {SourceMap.FLAG_SOLID}}\n"
+		"local map = SourceMap.map_create {size = {12, 6}, flags = SourceMap.FLAG_SOLID}\n"
+		"SourceMap.rectangle_apply {map = map, area = {1, 1, 4, 5}, fill_operator = {remove = SourceMap.FLAG_SOLID}}\n"
+		"SourceMap.rectangle_apply {map = map, area = {6, 1, 11, 5}, fill_operator = {remove = SourceMap.FLAG_SOLID}}\n"
+		"local components, largest = SourceMap.map_components {map = map, selector = floor}\n"
+		"assert(#components == 2 and largest == 2, 'two rooms, the second largest')\n"
+		"assert(components[1].size == 12 and components[2].size == 20, 'room sizes')\n"
+		"assert(components[1].first[1] == 1 and components[1].first[2] == 1, 'first square')\n"
+		"SourceMap.map_components {map = map, selector = floor, keep_seed = {2, 2},\n"
+		"    fill_operator = {add = SourceMap.FLAG_SOLID}}\n"
+		"components, largest = SourceMap.map_components {map = map, selector = floor}\n"
+		"assert(#components == 1 and components[1].size == 12, 'only the seeded room is kept')\n";
+
+SUITE(map_components_tests) {
+	TEST(map_components_match_flood_fill) {
+		MTwist rng(3);
+		Selector floor(0, FLAG_SOLID);
+		for (int trial = 0; trial < 200; trial++) {
+			Map map(Size(rng.rand(1, 40), rng.rand(1, 40)));
+			int density = rng.rand(1, 8);
+			FOR_EACH_BBOX(BBox(Pos(0, 0), map.size()), x, y) {
+				map[Pos(x, y)].flags = rng.rand(10) < density ? FLAG_SOLID : 0;
+			}
+
+			MapComponents components;
+			area_components(map, BBox(Pos(0, 0), map.size()), floor, components);
+			int total = 0;
+			for (int i = 0; i < (int)components.components.size(); i++) {
+				MapComponent& component = components.components[i];
+				CHECK(components.label(component.first) == i);
+				CHECK(flood_fill_size(map, component.first, floor) == component.size);
+				total += component.size;
+			}
+			FOR_EACH_BBOX(BBox(Pos(0, 0), map.size()), x, y) {
+				int label = components.label(Pos(x, y));
+				CHECK((label != -1) == map[Pos(x, y)].matches(floor));
+				if (label != -1) {
+					CHECK(components.components[label].bbox.contains(x, y));
+					total--;
+				}
+			}
+			CHECK(total == 0);
+
+			Map marked = map;
+			bool connected = area_fully_connected(marked, BBox(Pos(0, 0), map.size()), floor,
+					Operator(FLAG_RESERVED2), Selector(FLAG_RESERVED2));
+			CHECK(connected == (components.components.size() <= 1));
+
+			/* Filling all but the largest leaves one component */
+			area_components_fill(map, components, components.largest(), Operator(FLAG_SOLID));
+			area_components(map, BBox(Pos(0, 0), map.size()), floor, components);
+			CHECK(components.components.size() <= 1);
+		}
+	}
+
+	TEST(lua_map_components) {
+		TestLuaState L;
+		luaL_openlibs(L);
+		lua_register_lcommon(L);
+		lua_settop(L, 0);
+		LuaValue map_gen = lua_api::register_lua_submodule(L, "core.SourceMap");
+		lua_register_ldungeon(map_gen, false);
+		lua_assert_valid_dostring(L, LUA_COMPONENTS_CODE);
+		L.finish_check();
+	}
+}
@@ -0,0 +1,132 @@
+#include <vector>
+
+#include <lcommon/unittest.h>
+#include <lcommon/mtwist.h>
+
+#include <ldungeon_gen/Map.h>
+#include <ldungeon_gen/map_span.h>
+
+using namespace ldungeon_gen;
+
+/* Small value ranges so that selectors & operators hit often */
+static uint16_t random_bits(MTwist& rng) {
+	return rng.rand(16);
+}
+
+static Range16 random_range(MTwist& rng) {
+	Range16 range;
+	if (rng.rand(3) != 0) {
+		/* Includes inverted & half open ranges, which Range16() can't construct */
+		range.min = rng.rand(6) == 0 ? UNSET : rng.rand(8);
+		range.max = rng.rand(6) == 0 ? UNSET : rng.rand(8);
+	}
+	return range;
+}
+
+static Square random_square(MTwist& rng) {
+	Square sqr(random_bits(rng), rng.rand(4));
+	sqr.group = rng.rand(10) == 0 ? UNSET : rng.rand(8);
+	return sqr;
+}
+
+static Selector random_selector(MTwist& rng) {
+	Selector selector(random_bits(rng) & random_bits(rng), random_bits(rng) & random_bits(rng));
+	if (rng.rand(2) == 0) {
+		selector = Selector(selector.must_be_on_bits, selector.must_be_off_bits, rng.rand(4));
+	}
+	selector.must_be_group = random_range(rng);
+	selector.cant_be_group = random_range(rng);
+	return selector;
+}
+
+static Operator random_operator(MTwist& rng) {
+	Operator oper(random_bits(rng), random_bits(rng), random_bits(rng));
+	if (rng.rand(2) == 0) {
+		oper.content_value = rng.rand(4);
+	}
+	if (rng.rand(2) == 0) {
+		oper.group_value = rng.rand(8);
+	}
+	return oper;
+}
+
+static std::vector<Square> random_row(MTwist& rng, int n) {
+	std::vector<Square> row;
+	for (int i = 0; i < n; i++) {
+		row.push_back(random_square(rng));
+	}
+	return row;
+}
+
+static bool same_squares(const std::vector<Square>& a, const std::vector<Square>& b) {
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i].flags != b[i].flags || a[i].content != b[i].content || a[i].group != b[i].group) {
+			return false;
+		}
+	}
+	return a.size() == b.size();
+}
+
+SUITE(map_span_tests) {
+	TEST(span_matches_square_matches) {
+		MTwist rng(1);
+		for (int trial = 0; trial < 2000; trial++) {
+			std::vector<Square> row = random_row(rng, rng.rand(1, 150));
+			Selector selector = random_selector(rng), excluded = random_selector(rng);
+			int n = row.size();
+
+			std::vector<int> expected;
+			int first = -1, first_unexcluded = -1;
+			for (int i = 0; i < n; i++) {
+				if (row[i].matches(selector)) {
+					expected.push_back(i);
+					if (first == -1) {
+						first = i;
+					}
+					if (first_unexcluded == -1 && !row[i].matches(excluded)) {
+						first_unexcluded = i;
+					}
+				}
+			}
+			std::vector<int> offsets;
+			span_collect_matches(&row[0], n, selector, offsets);
+			CHECK(offsets == expected);
+			CHECK(span_all_match(&row[0], n, selector) == ((int)expected.size() == n));
+			CHECK(span_find_match(&row[0], n, selector) == first);
+			CHECK(span_find_match(&row[0], n, selector, excluded) == first_unexcluded);
+		}
+	}
+
+	TEST(span_apply_matches_square_apply) {
+		MTwist rng(2);
+		for (int trial = 0; trial < 2000; trial++) {
+			std::vector<Square> row = random_row(rng, rng.rand(1, 150));
+			ConditionalOperator oper(random_selector(rng), random_operator(rng));
+
+			std::vector<Square> expected = row, actual = row;
+			for (Square& sqr : expected) {
+				sqr.apply(oper.oper);
+			}
+			span_apply(&actual[0], actual.size(), oper.oper);
+			CHECK(same_squares(expected, actual));
+
+			expected = row, actual = row;
+			for (Square& sqr : expected) {
+				sqr.apply(oper);
+			}
+			span_apply(&actual[0], actual.size(), oper);
+			CHECK(same_squares(expected, actual));
+		}
+	}
+
+	TEST(span_empty_runs) {
+		Square sqr(0, 0);
+		std::vector<int> offsets;
+		CHECK(span_all_match(&sqr, 0, Selector(FLAG_SOLID)));
+		CHECK(span_find_match(&sqr, 0, Selector()) == -1);
+		span_collect_matches(&sqr, 0, Selector(), offsets);
+		CHECK(offsets.empty());
+		span_apply(&sqr, 0, Operator(FLAG_SOLID));
+		CHECK(sqr.flags == 0);
+	}
+}
@@ -0,0 +1,137 @@
+/*
+ * worker_pool.cpp:
+ *  A small pool of worker threads for data-parallel loops in the simulation.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <SDL_cpuinfo.h>
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+
+#include "worker_pool.h"
+
+// Threads beyond this rarely pay for their synchronization at our loop sizes
+static const int MAX_DEFAULT_THREADS = 3;
+
+WorkerPool::WorkerPool() :
+		_func(NULL), _data(NULL), _n(0), _n_ranges(0), _generation(0), _remaining(0), _quit(false) {
+	_lock = SDL_CreateMutex();
+	_has_work = SDL_CreateCond();
+	_work_done = SDL_CreateCond();
+}
+
+WorkerPool::~WorkerPool() {
+	stop_threads();
+	SDL_DestroyCond(_work_done);
+	SDL_DestroyCond(_has_work);
+	SDL_DestroyMutex(_lock);
+}
+
+void WorkerPool::set_threads(int n_threads) {
+	stop_threads();
+	for (int i = 0; i < n_threads; i++) {
+		Worker* worker = new Worker {this, i + 1, _generation, NULL};
+		worker->thread = SDL_CreateThread(worker_main, "worker-thread", worker);
+		if (worker->thread == NULL) {
+			// Fewer threads only costs speed, never changes results
+			fprintf(stderr, "Could not create worker thread: %s\n", SDL_GetError());
+			delete worker;
+			break;
+		}
+		_workers.push_back(worker);
+	}
+}
+
+void WorkerPool::stop_threads() {
+	SDL_LockMutex(_lock);
+	_quit = true;
+	SDL_CondBroadcast(_has_work);
+	SDL_UnlockMutex(_lock);
+	for (Worker* worker : _workers) {
+		SDL_WaitThread(worker->thread, NULL);
+		delete worker;
+	}
+	_workers.clear();
+	_quit = false;
+}
+
+static void run_range(WorkerPool::RangeFunc func, void* data, size_t n, int range, int n_ranges) {
+	size_t begin = n * range / n_ranges, end = n * (range + 1) / n_ranges;
+	if (begin < end) {
+		func(data, begin, end);
+	}
+}
+
+void WorkerPool::parallel_for(size_t n, RangeFunc func, void* data,
+		size_t min_per_range) {
+	int n_ranges = (int)std::min(_workers.size() + 1, n / std::max(min_per_range, (size_t)1));
+	if (n_ranges <= 1) {
+		func(data, 0, n);
+		return;
+	}
+
+	SDL_LockMutex(_lock);
+	_func = func, _data = data, _n = n, _n_ranges = n_ranges;
+	_remaining = _workers.size();
+	_generation++;
+	SDL_CondBroadcast(_has_work);
+	SDL_UnlockMutex(_lock);
+
+	// The calling thread takes the first range
+	run_range(func, data, n, 0, n_ranges);
+
+	SDL_LockMutex(_lock);
+	while (_remaining > 0) {
+		SDL_CondWait(_work_done, _lock);
+	}
+	SDL_UnlockMutex(_lock);
+}
+
+int WorkerPool::worker_main(void* arg) {
+	Worker* worker = (Worker*)arg;
+	WorkerPool* pool = worker->pool;
+	int seen_generation = worker->seen_generation;
+
+	SDL_LockMutex(pool->_lock);
+	while (true) {
+		while (!pool->_quit && pool->_generation == seen_generation) {
+			SDL_CondWait(pool->_has_work, pool->_lock);
+		}
+		if (pool->_quit) {
+			break;
+		}
+		seen_generation = pool->_generation;
+		RangeFunc func = pool->_func;
+		void* data = pool->_data;
+		size_t n = pool->_n;
+		int n_ranges = pool->_n_ranges;
+		SDL_UnlockMutex(pool->_lock);
+
+		if (worker->index < n_ranges) {
+			run_range(func, data, n, worker->index, n_ranges);
+		}
+
+		SDL_LockMutex(pool->_lock);
+		if (--pool->_remaining == 0) {
+			SDL_CondSignal(pool->_work_done);
+		}
+	}
+	SDL_UnlockMutex(pool->_lock);
+	return 0;
+}
+
+WorkerPool& worker_pool() {
+	static WorkerPool* pool = NULL;
+	if (pool == NULL) {
+		pool = new WorkerPool();
+		int n_threads = std::min(SDL_GetCPUCount() - 1, MAX_DEFAULT_THREADS);
+		if (getenv("LANARTS_WORKER_THREADS")) {
+			n_threads = atoi(getenv("LANARTS_WORKER_THREADS"));
+		}
+		pool->set_threads(std::max(n_threads, 0));
+	}
+	return *pool;
+}
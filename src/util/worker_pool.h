@@ -0,0 +1,65 @@
+/*
+ * worker_pool.h:
+ *  A small pool of worker threads for data-parallel loops in the simulation.
+ *  Work is split into a fixed set of contiguous ranges, so a loop whose
+ *  iterations only write their own data gives the same result for any
+ *  thread count, as required by lockstep netplay.
+ */
+
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <cstddef>
+#include <vector>
+
+struct SDL_mutex;
+struct SDL_cond;
+struct SDL_Thread;
+
+class WorkerPool {
+public:
+	typedef void (*RangeFunc)(void* data, size_t begin, size_t end);
+
+	WorkerPool();
+	~WorkerPool();
+
+	/* Number of threads besides the caller, 0 runs every loop on the caller. */
+	void set_threads(int n_threads);
+	int threads() const {
+		return (int)_workers.size();
+	}
+
+	/* Calls func(data, begin, end) over [0, n), using at most one range per
+	 * thread and at least 'min_per_range' iterations per range.
+	 * Returns once all ranges are done. Not reentrant. */
+	void parallel_for(size_t n, RangeFunc func, void* data,
+			size_t min_per_range = 1);
+
+private:
+	struct Worker {
+		WorkerPool* pool;
+		int index;
+		// Last loop taken, set before the thread starts so no loop is missed
+		int seen_generation;
+		SDL_Thread* thread;
+	};
+	static int worker_main(void* worker);
+	void stop_threads();
+
+	std::vector<Worker*> _workers;
+	SDL_mutex* _lock;
+	SDL_cond* _has_work;
+	SDL_cond* _work_done;
+
+	// Current loop, guarded by _lock
+	RangeFunc _func;
+	void* _data;
+	size_t _n;
+	int _n_ranges, _generation, _remaining;
+	bool _quit;
+};
+
+/* Shared pool, sized from LANARTS_WORKER_THREADS or the CPU count. */
+WorkerPool& worker_pool();
+
+#endif /* WORKER_POOL_H_ */